@@ -10,7 +10,9 @@
 #include "./computational-geometry/sat.h"
 #include "./computational-geometry/gjk.h"
 #include "./computational-geometry/epa.h"
+#include "./computational-geometry/spatial-sort.h"
 #include "./helpers/timer.h"
+#include "./helpers/random.h"
 
 struct convex_hull_test {
     std::vector<vector_2d<double>> input_points, expected_result;
@@ -265,6 +267,26 @@ bool almost_equal(const vector_2d<T> &vector_a, const vector_2d<T> &vector_b) {
 // 6) add/think about escapes for while(true) loops
 // 7) will GJK be faster if we maintain the ccw winding of simplex?
 
+std::vector<vector_2d<double>> random_points(int count, std::uint64_t seed) {
+    xoshiro256_star_star generator(seed);
+    std::vector<vector_2d<double>> points(count);
+    for (vector_2d<double> &point : points) {
+        point = { uniform_real(generator) - 0.5, uniform_real(generator) - 0.5 };
+    }
+    return points;
+}
+
+// the length of the path through the points in order (which is shorter the more
+// the points near each other in the list are near each other in space):
+double path_length(const std::vector<vector_2d<double>> &points) {
+    double length = 0;
+    for (int i = 1, l = points.size(); i < l; i++) {
+        vector_2d<double> step = points[i] - points[i - 1];
+        length += std::sqrt(step.dot(step));
+    }
+    return length;
+}
+
 int main() {
 
     // make sure all intersection_tests shapes are convex:
@@ -332,6 +354,60 @@ int main() {
         std::cout << "PASSED\n";
     }
 
+    {
+        std::cout << "SPATIAL SORT:\n    ";
+
+        // consecutive cells along the hilbert curve are always next to each other:
+        std::vector<std::pair<std::uint64_t, vector_2d<int>>> cells;
+        for (int x = 0; x < 64; x++) {
+            for (int y = 0; y < 64; y++) {
+                cells.push_back({ hilbert_key(x << 26, y << 26), { x, y } });
+            }
+        }
+        std::sort(cells.begin(), cells.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (int i = 1, l = cells.size(); i < l; i++) {
+            vector_2d<int> step = cells[i].second - cells[i - 1].second;
+            if (cells[i].first == cells[i - 1].first || std::abs(step.x) + std::abs(step.y) != 1) {
+                std::cout << "FAILED\n";
+                throw;
+            }
+        }
+        std::cout << "0 ";
+
+        if (morton_key(1, 0) != 1 || morton_key(0, 1) != 2 || morton_key(3, 3) != 15) {
+            std::cout << "FAILED\n";
+            throw;
+        }
+        std::cout << "1 ";
+
+        // sorting along either curve is a permutation, which makes the path much shorter:
+        std::vector<vector_2d<double>> points = random_points(10000, 1);
+        for (space_filling_curve curve : { space_filling_curve::morton, space_filling_curve::hilbert }) {
+            std::vector<vector_2d<double>> sorted(points);
+            spatial_sort(sorted, curve);
+            std::cout << static_cast<int>(curve) + 2 << " ";
+            if (!std::is_permutation(sorted.begin(), sorted.end(), points.begin(), [](const auto &a, const auto &b) {
+                    return a.x == b.x && a.y == b.y;
+                }) || path_length(sorted) > path_length(points) / 10) {
+                std::cout << "FAILED\n";
+                throw;
+            }
+        }
+
+        // degenerate bounding boxes:
+        std::vector<vector_2d<double>> empty, same(10, { 1.0, 2.0 }), line { { 3, 0 }, { 1, 0 }, { 2, 0 } };
+        spatial_sort(empty);
+        spatial_sort(same);
+        spatial_sort(line);
+        std::cout << "4 ";
+        if (line[0].x != 1 || line[1].x != 2 || line[2].x != 3) {
+            std::cout << "FAILED\n";
+            throw;
+        }
+
+        std::cout << "PASSED\n";
+    }
+
     std::cout << "\nALL GOOD... :)\n\n";
 
 
@@ -391,4 +467,18 @@ int main() {
                     << test_timer.get_ticks() / (1000.0 * intersection_tests.size()) << " ms/1k ops)\n";
     }
 
+    test_timer.reset();
+
+    {
+        std::vector<vector_2d<double>> points = random_points(1000000, 2);
+        for (space_filling_curve curve : { space_filling_curve::morton, space_filling_curve::hilbert }) {
+            std::vector<vector_2d<double>> sorted(points);
+            test_timer.reset();
+            spatial_sort(sorted, curve);
+            std::cout << (curve == space_filling_curve::morton ? "morton" : "hilbert") << " spatial sort time (1M points): "
+                        << test_timer.get_ticks() / 1000.0 << " ms (path length " << path_length(points)
+                        << " -> " << path_length(sorted) << ")\n";
+        }
+    }
+
 }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "./vector-2d.h"
+#include "../sort/argsort.h"
+
+// orders points along a space filling curve, so that points that are near each other
+// in space (mostly) end up near each other in memory, which makes anything that then
+// works through the points neighbourhood by neighbourhood much kinder to the cache.
+// the points' bounding box is divided into a 2^32 x 2^32 grid, and each point gets
+// the 64-bit position along the curve of the grid cell it falls in:
+// - a Morton (Z-order) key (ref: https://en.wikipedia.org/wiki/Z-order_curve) just
+//   interleaves the bits of the x and y cells, so it's very cheap to calculate, but
+//   it makes long jumps between quadrants;
+// - a Hilbert key (ref: https://en.wikipedia.org/wiki/Hilbert_curve) takes a bit
+//   longer, but the curve never jumps, so neighbouring keys are always neighbouring
+//   cells, which gives better locality.
+// the points are then put in order of key by argsort (which radix sorts the
+// (key, index) pairs), with each point moved just once, at the end.
+
+enum class space_filling_curve {
+    morton = 0,
+    hilbert = 1
+};
+
+// spreads the bits of value out into the even bits of the result:
+inline std::uint64_t spread_bits(std::uint32_t value) {
+
+#if defined(__BMI2__)
+    return _pdep_u64(value, UINT64_C(0x5555555555555555));
+#else
+    std::uint64_t bits = value;
+    bits = (bits | (bits << 16)) & UINT64_C(0x0000ffff0000ffff);
+    bits = (bits | (bits << 8)) & UINT64_C(0x00ff00ff00ff00ff);
+    bits = (bits | (bits << 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    bits = (bits | (bits << 2)) & UINT64_C(0x3333333333333333);
+    bits = (bits | (bits << 1)) & UINT64_C(0x5555555555555555);
+    return bits;
+#endif
+
+}
+
+inline std::uint64_t morton_key(std::uint32_t x, std::uint32_t y) {
+    return spread_bits(x) | (spread_bits(y) << 1);
+}
+
+// the distance along a Hilbert curve filling the 2^32 x 2^32 grid of cell (x, y).
+// the obvious way is to work down from the top bit, with each bit of x and y picking
+// one of the four quadrants, and then reflecting/rotating the coordinates so that the
+// quadrant's part of the curve has the same orientation as the whole - but that's 32
+// dependent (and unpredictable) steps. instead, the orientation at every level is
+// worked out at once, with a parallel prefix scan over the bits (ref:
+// https://threadlocalmutex.com/?p=126), which is branchless and takes 5 rounds:
+inline std::uint64_t hilbert_key(std::uint32_t x, std::uint32_t y) {
+
+    // the first round of the scan, from the quadrant that each bit of x and y picks:
+    std::uint32_t a = x ^ y;
+    std::uint32_t b = ~a;
+    std::uint32_t c = ~(x | y);
+    std::uint32_t d = x & ~y;
+
+    std::uint32_t A = a | (b >> 1);
+    std::uint32_t B = (a >> 1) ^ a;
+    std::uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    std::uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    for (int shift = 2; shift < 16; shift <<= 1) {
+
+        a = A;
+        b = B;
+        c = C;
+        d = D;
+
+        A = (a & (a >> shift)) ^ (b & (b >> shift));
+        B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+        C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+        D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+
+    }
+
+    c = C;
+    d = D;
+    C ^= (A & (c >> 16)) ^ (B & (d >> 16));
+    D ^= (B & (c >> 16)) ^ ((A ^ B) & (d >> 16));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    std::uint32_t low_bits = x ^ y;
+    std::uint32_t high_bits = b | ~(low_bits | a);
+
+    return (spread_bits(high_bits) << 1) | spread_bits(low_bits);
+
+}
+
+// the key of every point, along the given curve:
+template <typename T>
+std::vector<std::uint64_t> spatial_keys(const std::vector<vector_2d<T>> &points, space_filling_curve curve) {
+
+    int size = points.size();
+    std::vector<std::uint64_t> keys(size);
+    if (size == 0) { return keys; }
+
+    // the bounding box, and the scale that maps it onto the grid:
+    double min_x = points[0].x, max_x = points[0].x;
+    double min_y = points[0].y, max_y = points[0].y;
+    for (const vector_2d<T> &point : points) {
+        min_x = std::min<double>(min_x, point.x);
+        max_x = std::max<double>(max_x, point.x);
+        min_y = std::min<double>(min_y, point.y);
+        max_y = std::max<double>(max_y, point.y);
+    }
+
+    constexpr double grid_max = 4294967295.0;
+    double scale_x = max_x > min_x ? grid_max / (max_x - min_x) : 0.0;
+    double scale_y = max_y > min_y ? grid_max / (max_y - min_y) : 0.0;
+
+    for (int i = 0; i < size; i++) {
+
+        // NB: clamping, in case rounding takes the maximum just past the end of the grid:
+        std::uint32_t x = static_cast<std::uint32_t>(std::min((points[i].x - min_x) * scale_x, grid_max));
+        std::uint32_t y = static_cast<std::uint32_t>(std::min((points[i].y - min_y) * scale_y, grid_max));
+
+        keys[i] = curve == space_filling_curve::morton ? morton_key(x, y) : hilbert_key(x, y);
+
+    }
+
+    return keys;
+
+}
+
+// reorders points along the given curve:
+template <typename T>
+void spatial_sort(std::vector<vector_2d<T>> &points, space_filling_curve curve = space_filling_curve::hilbert) {
+
+    std::vector<int> order = argsort(spatial_keys(points, curve));
+    apply_permutation(order, points);
+
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <cmath>
+#include <array>
 #include <iostream>
 
 template <typename T>
@@ -0,0 +1,292 @@
+
+// small, fast, seedable random number generators, which are much cheaper to create,
+// copy and run than std::mt19937 (whose state is 2.5KB):
+// - xoshiro256_star_star (ref: https://prng.di.unimi.it/): 256 bits of state, and a
+//   jump() that skips 2^128 outputs ahead, so that independent streams (e.g. one per
+//   thread) can be split off from a single seed without any chance of overlapping;
+// - wyrand (ref: https://github.com/wangyi-fudan/wyhash): 64 bits of state, and
+//   the quickest of the three (where 128-bit multiplication is available);
+// - pcg32 (ref: https://www.pcg-random.org/): 64 bits of state, 32-bit output,
+//   and a separate stream selector, so that every stream is a different sequence.
+// they all satisfy UniformRandomBitGenerator, so they can be used with std::shuffle
+// and the std distributions, and they're all deterministic given a seed (seeds
+// are passed through splitmix64 first, so similar seeds give unrelated states).
+// random_seed() gets a non-deterministic seed, and default_generator() is a
+// generator for each thread, seeded once on first use.
+// there are also functions for filling whole ranges at once, which avoid the per
+// call overhead of the std distributions. fill_bernoulli (like weighted_coin) compares
+// raw integer output against a threshold, rather than converting each value to a
+// double, and gets two coin tosses from each 64-bit output.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <iterator>
+#include <random>
+#include <algorithm>
+
+// ref: https://prng.di.unimi.it/splitmix64.c
+inline std::uint64_t splitmix64(std::uint64_t &state) {
+
+    std::uint64_t z = (state += UINT64_C(0x9e3779b97f4a7c15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+
+}
+
+inline std::uint64_t rotate_left(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+class xoshiro256_star_star {
+
+public:
+
+    using result_type = std::uint64_t;
+
+    // the stream'th of the independent streams for seed (each being the one before,
+    // jumped ahead by 2^128):
+    explicit xoshiro256_star_star(std::uint64_t seed = 0, int stream = 0) {
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = splitmix64(seed);
+        }
+
+        for (int i = 0; i < stream; i++) {
+            jump();
+        }
+
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+
+        std::uint64_t result = rotate_left(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate_left(state[3], 45);
+
+        return result;
+
+    }
+
+    // equivalent to 2^128 calls to operator():
+    void jump() {
+
+        static constexpr std::uint64_t jump_polynomial[4] = {
+            UINT64_C(0x180ec6d33cfd0aba), UINT64_C(0xd5a61266f0c9392c),
+            UINT64_C(0xa9582618e03fc9aa), UINT64_C(0x39abdc4529b1661c)
+        };
+
+        std::uint64_t jumped[4] = { 0, 0, 0, 0 };
+        for (std::uint64_t polynomial : jump_polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (polynomial & (UINT64_C(1) << bit)) {
+                    for (int i = 0; i < 4; i++) { jumped[i] ^= state[i]; }
+                }
+                (*this)();
+            }
+        }
+
+        std::copy(jumped, jumped + 4, state);
+
+    }
+
+private:
+
+    std::uint64_t state[4];
+
+};
+
+class wyrand {
+
+public:
+
+    using result_type = std::uint64_t;
+
+    // NB: streams are just differently seeded, so (unlike the others) they're
+    // different points in the same sequence, rather than guaranteed not to overlap.
+    // with a period of 2^64, it's very unlikely to matter in practice:
+    explicit wyrand(std::uint64_t seed = 0, int stream = 0) {
+        seed += static_cast<std::uint64_t>(stream) * UINT64_C(0xd1b54a32d192ed03);
+        state = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+
+        state += UINT64_C(0xa0761d6478bd642f);
+
+#if defined(__SIZEOF_INT128__)
+        __uint128_t product = static_cast<__uint128_t>(state) * (state ^ UINT64_C(0xe7037ed1a0b428db));
+        return static_cast<std::uint64_t>(product >> 64) ^ static_cast<std::uint64_t>(product);
+#else
+        // the 64 x 64 -> 128 bit multiplication, done in 32-bit halves:
+        std::uint64_t a = state;
+        std::uint64_t b = state ^ UINT64_C(0xe7037ed1a0b428db);
+        std::uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+        std::uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+        std::uint64_t low_low = a_low * b_low, low_high = a_low * b_high;
+        std::uint64_t high_low = a_high * b_low, high_high = a_high * b_high;
+        std::uint64_t middle = (low_low >> 32) + (low_high & 0xffffffff) + (high_low & 0xffffffff);
+        std::uint64_t low = (low_low & 0xffffffff) | (middle << 32);
+        std::uint64_t high = high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+        return high ^ low;
+#endif
+
+    }
+
+private:
+
+    std::uint64_t state;
+
+};
+
+class pcg32 {
+
+public:
+
+    using result_type = std::uint32_t;
+
+    explicit pcg32(std::uint64_t seed = 0, int stream = 0):
+        state(0), increment((static_cast<std::uint64_t>(stream) << 1) | 1) {
+        (*this)();
+        state += splitmix64(seed);
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    // PCG-XSH-RR:
+    result_type operator()() {
+
+        std::uint64_t old_state = state;
+        state = old_state * UINT64_C(6364136223846793005) + increment;
+
+        std::uint32_t xor_shifted = static_cast<std::uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+        int rotation = old_state >> 59;
+        return (xor_shifted >> rotation) | (xor_shifted << ((32 - rotation) & 31));
+
+    }
+
+private:
+
+    std::uint64_t state;
+    std::uint64_t increment;
+
+};
+
+// a (non-deterministic) seed from std::random_device:
+inline std::uint64_t random_seed() {
+
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+
+}
+
+// a generator for the calling thread, randomly seeded the first time it's used
+// (so, unlike creating a std::random_device every time, this is cheap to call often):
+inline xoshiro256_star_star& default_generator() {
+
+    thread_local xoshiro256_star_star generator(random_seed());
+    return generator;
+
+}
+
+// a double in [0, 1), from the top 53 bits of a 64-bit output:
+template <typename Generator>
+double uniform_real(Generator &generator) {
+
+    static_assert(Generator::max() == std::numeric_limits<std::uint64_t>::max(), "uniform_real needs a 64-bit generator");
+    return (generator() >> 11) * (1.0 / (UINT64_C(1) << 53));
+
+}
+
+// an integer in [0, bound), without the bias of generator() % bound, using Lemire's
+// multiply-and-reject method (ref: https://arxiv.org/abs/1805.10941):
+template <typename Generator>
+std::uint32_t uniform_int(Generator &generator, std::uint32_t bound) {
+
+    std::uint64_t product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(generator())) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+
+    if (low < bound) {
+        std::uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(generator())) * bound;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+
+    return product >> 32;
+
+}
+
+// fills [first, last) with raw output (truncated to the range's value type):
+template <typename Generator, typename OutputIt>
+void fill_random(Generator &generator, OutputIt first, OutputIt last) {
+
+    using value_type = typename std::iterator_traits<OutputIt>::value_type;
+    for (; first != last; ++first) {
+        *first = static_cast<value_type>(generator());
+    }
+
+}
+
+// fills [first, last) with doubles in [0, 1):
+template <typename Generator, typename OutputIt>
+void fill_uniform_real(Generator &generator, OutputIt first, OutputIt last) {
+
+    for (; first != last; ++first) {
+        *first = uniform_real(generator);
+    }
+
+}
+
+// the threshold that a 32-bit random value is below with the given probability
+// (so 2^32 for a probability of 1):
+inline std::uint64_t bernoulli_threshold(double probability) {
+
+    probability = std::max(0.0, std::min(probability, 1.0));
+    return static_cast<std::uint64_t>(probability * 4294967296.0);
+
+}
+
+// fills [first, last) with bools that are each true if a 32-bit random value is
+// below threshold (i.e. with a probability of threshold / 2^32), taking two from
+// each 64-bit output:
+template <typename Generator, typename OutputIt>
+void fill_below_threshold(Generator &generator, OutputIt first, OutputIt last, std::uint64_t threshold) {
+
+    static_assert(Generator::max() == std::numeric_limits<std::uint64_t>::max(), "fill_below_threshold needs a 64-bit generator");
+
+    while (first != last) {
+
+        std::uint64_t random = generator();
+        *first = (random & 0xffffffff) < threshold;
+        if (++first == last) { break; }
+        *first = (random >> 32) < threshold;
+        ++first;
+
+    }
+
+}
+
+// fills [first, last) with bools that are each true with the given probability
+// (to within 2^-32):
+template <typename Generator, typename OutputIt>
+void fill_bernoulli(Generator &generator, OutputIt first, OutputIt last, double probability) {
+    fill_below_threshold(generator, first, last, bernoulli_threshold(probability));
+}
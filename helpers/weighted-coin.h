@@ -1,29 +1,40 @@
 
-#include <random>
-#include <algorithm>
+#pragma once
+
+#include <cstdint>
+
+#include "./random.h"
 
 class weighted_coin {
 
 public:
+    // NB: true_probability is clamped to [0, 1], and is accurate to within 2^-32:
     weighted_coin(double true_probability):
-        generator(rd()), distribution(0.0, 1.0), true_probability(true_probability)
-        {
-            // clamp trueProbability to [0, 1]:
-            true_probability = std::max(0.0, std::min(true_probability, 1.0));
-        }
+        weighted_coin(true_probability, random_seed()) {}
+
+    // a coin that always gives the same sequence of tosses for the same seed:
+    weighted_coin(double true_probability, std::uint64_t seed):
+        generator(seed), threshold(bernoulli_threshold(true_probability)) {}
 
     bool toss() {
 
-        return distribution(generator) < true_probability;
+        // compare the top 32 bits against the threshold, rather than converting to a
+        // double and comparing against the probability:
+        return (generator() >> 32) < threshold;
+
+    }
+
+    // tosses the coin once for each element of [first, last):
+    template <typename OutputIt>
+    void toss(OutputIt first, OutputIt last) {
+
+        fill_below_threshold(generator, first, last, threshold);
 
     }
 
 private:
-    static std::random_device rd;  // used to obtain a seed for the random number engine
-    std::mt19937 generator;  // standard mersenne_twister_engine seeded with rd()
-    std::uniform_real_distribution<double> distribution;
-    float true_probability;
+    xoshiro256_star_star generator;
+    // a toss is true if a 32-bit random value is below this:
+    std::uint64_t threshold;
 
 };
-
-std::random_device weighted_coin::rd = std::random_device();
@@ -9,9 +9,18 @@
 #include <vector>
 #include <atomic>
 #include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <numeric>
+#include <algorithm>
 
 #include "./multi-threaded/threadsafe-queue.h"
 #include "./multi-threaded/thread-pool.h"
+#include "./multi-threaded/parallel-algorithms.h"
+#include "./multi-threaded/bounded-queue.h"
+#include "./multi-threaded/spsc-queue.h"
 
 threadsafe_queue<std::tuple<std::thread::id, int, int>> queue;
 std::mutex cout_mutex;
@@ -74,6 +83,164 @@ int main() {
 
     }
 
+    {
+
+        // bursts of items pushed in bulk, and popped in batches by several consumers:
+        threadsafe_queue<int> bursts;
+        std::atomic<long long> total = 0;
+        std::vector<std::thread> consumers;
+
+        for (int i = 0; i < 4; i++) {
+            consumers.emplace_back([&bursts, &total]() {
+                std::vector<int> batch;
+                long long sum = 0;
+                while (bursts.pop_bulk(std::back_inserter(batch), 100) > 0) {
+                    for (int value : batch) { sum += value; }
+                    batch.clear();
+                }
+                total += sum;
+            });
+        }
+
+        std::vector<int> burst(1000);
+        for (int i = 0; i < 1000; i++) {
+            for (int j = 0; j < 1000; j++) { burst[j] = i * 1000 + j; }
+            bursts.push_bulk(burst.begin(), burst.end());
+        }
+        bursts.finish();
+
+        for (int i = 0, l = consumers.size(); i < l; i++) {
+            consumers[i].join();
+        }
+
+        std::cout << "bulk push/pop: " << (total == 999999LL * 1000000 / 2 ? "all items consumed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // a small bounded_queue, so that producers regularly find it full:
+        bounded_queue<long long> bounded(64);
+        const int num_items = 1000000;
+        std::atomic<long long> total = 0;
+        std::vector<std::thread> producers;
+        std::vector<std::thread> consumers;
+
+        for (int i = 0; i < 4; i++) {
+            producers.emplace_back([&bounded]() {
+                for (int j = 1; j <= num_items; j++) {
+                    bounded.push(j);
+                }
+            });
+            consumers.emplace_back([&bounded, &total]() {
+                long long value, sum = 0;
+                while (bounded.wait_and_pop(value)) {
+                    sum += value;
+                }
+                total += sum;
+            });
+        }
+
+        for (int i = 0, l = producers.size(); i < l; i++) {
+            producers[i].join();
+        }
+
+        bounded.finish();
+
+        for (int i = 0, l = consumers.size(); i < l; i++) {
+            consumers[i].join();
+        }
+
+        std::cout << "bounded queue: " << (total == 4LL * num_items * (num_items + 1) / 2 ? "all items consumed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // finish whilst pushes are still going on: every producer has started it's last
+        // push (which, with such a small queue, is usually waiting for room) before
+        // finish is called, so consumers see the queue finished whilst producers are
+        // still waiting on it. every item has to be either consumed or left in the queue:
+        bool all_accounted_for = true;
+
+        for (int round = 0; round < 200; round++) {
+
+            bounded_queue<long long> bounded(2);
+            const int num_items = 100;
+            std::atomic<long long> total = 0;
+            std::atomic<int> last_pushes_started = 0;
+            std::vector<std::thread> producers;
+            std::vector<std::thread> consumers;
+
+            for (int i = 0; i < 4; i++) {
+                producers.emplace_back([&bounded, &last_pushes_started]() {
+                    for (int j = 1; j < num_items; j++) {
+                        bounded.push(j);
+                    }
+                    last_pushes_started++;
+                    bounded.push(num_items);
+                });
+                consumers.emplace_back([&bounded, &total]() {
+                    long long value, sum = 0;
+                    while (bounded.wait_and_pop(value)) {
+                        sum += value;
+                    }
+                    total += sum;
+                });
+            }
+
+            while (last_pushes_started < 4) { std::this_thread::yield(); }
+            bounded.finish();
+
+            for (int i = 0, l = producers.size(); i < l; i++) {
+                producers[i].join();
+            }
+            for (int i = 0, l = consumers.size(); i < l; i++) {
+                consumers[i].join();
+            }
+
+            long long value, left = 0;
+            while (bounded.try_and_pop(value)) { left += value; }
+
+            all_accounted_for = all_accounted_for && total + left == 4LL * num_items * (num_items + 1) / 2;
+
+        }
+
+        std::cout << "finish during pushes: " << (all_accounted_for ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // a two stage pipeline: items are pushed in batches, and have to arrive in order:
+        spsc_queue<int> pipeline(256);
+        const int num_items = 1000000;
+        bool in_order = true;
+
+        std::thread consumer([&pipeline, &in_order]() {
+            int batch[64];
+            int expected = 0;
+            int count;
+            while ((count = pipeline.pop_bulk(batch, 64)) > 0) {
+                for (int i = 0; i < count; i++) {
+                    in_order = in_order && batch[i] == expected++;
+                }
+            }
+            in_order = in_order && expected == num_items;
+        });
+
+        std::vector<int> batch(100);
+        for (int i = 0; i < num_items; i += batch.size()) {
+            for (int j = 0, l = batch.size(); j < l; j++) { batch[j] = i + j; }
+            pipeline.push_bulk(batch.begin(), batch.end());
+        }
+        pipeline.finish();
+        consumer.join();
+
+        std::cout << "spsc queue: " << (in_order ? "all items consumed in order" : "FAILED") << "\n";
+
+    }
+
     {
 
         thread_pool pool;
@@ -81,7 +248,7 @@ int main() {
         std::cout << "thread count: " << pool.get_thread_count() << "\n";
 
         for (int i = 0; i < 10; i++) {
-            pool.submit([i]() {
+            pool.submit_detached([i]() {
                 std::this_thread::sleep_for(std::chrono::milliseconds(500));
                 std::lock_guard lock(cout_mutex);
                 std::cout << std::this_thread::get_id() << " did nothing of use (" << i << ")\n"; 
@@ -97,30 +264,189 @@ int main() {
 
     {
 
-        // TODO: use latch here...
-
         thread_pool pool;
-        std::atomic<int> counter = 10;
-        std::promise<void> work_promise;
-        auto work_future = work_promise.get_future();
         std::vector<int> array = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+        std::vector<task_future<int>> futures;
 
         for (int i = 0; i < 10; i++) {
-            pool.submit([&array, i, &counter, &work_promise]() {
+            futures.push_back(pool.submit([&array, i]() {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1000));
                 array[i] *= 2;
-                counter--;
-                if (counter == 0) {
-                    work_promise.set_value();
-                }
-            });
+                return array[i];
+            }));
         }
 
         std::cout << "all work submitted...\n";
 
-        work_future.get();
+        int sum = 0;
+        for (task_future<int> &future : futures) {
+            sum += future.get();
+        }
+
+        std::cout << "futures: " << (sum == 110 ? "passed" : "FAILED") << "\n";
+
+    }
+
+    std::cout << "done...\n";
+
+    {
+
+        // tasks are move-only, so they can capture move-only things:
+        thread_pool pool;
+        std::promise<int> promise;
+        std::future<int> future = promise.get_future();
+        std::unique_ptr<int> value = std::make_unique<int>(20);
+
+        pool.submit([value = std::move(value), promise = std::move(promise)]() mutable {
+            promise.set_value(*value + 1);
+        });
+
+        std::cout << "move-only captures: " << (future.get() == 21 ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // tasks submitted from tasks go on the worker's own deque, and get stolen by
+        // the others. this spawns a binary tree of tasks, 2^16 - 1 in all, and then
+        // waits for the pool to run out of work:
+        thread_pool pool;
+        const int depth = 16;
+        std::atomic<int> tasks_run = 0;
+
+        std::function<void(int)> spawn = [&pool, &spawn, &tasks_run](int level) {
+            if (level > 1) {
+                pool.submit_detached([&spawn, level]() { spawn(level - 1); });
+                pool.submit_detached([&spawn, level]() { spawn(level - 1); });
+            }
+            tasks_run++;
+        };
+
+        pool.submit_detached([&spawn]() { spawn(depth); });
+        pool.wait_idle();
+
+        std::cout << "spawned " << tasks_run << " tasks from tasks: "
+            << (tasks_run == (1 << depth) - 1 ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // exceptions thrown by tasks end up in their task_future (or task_group):
+        thread_pool pool;
+
+        task_future<int> future = pool.submit([]() -> int { throw std::runtime_error("from a task"); });
+        bool future_threw = false;
+        try {
+            future.get();
+        } catch (const std::runtime_error &error) {
+            future_threw = std::string(error.what()) == "from a task";
+        }
+
+        task_group group(pool);
+        std::atomic<int> tasks_run = 0;
+        group.run_indexed(100, [&tasks_run](int i) {
+            tasks_run++;
+            if (i == 50) { throw std::logic_error("from a group"); }
+        });
+        bool group_threw = false;
+        try {
+            group.wait();
+        } catch (const std::logic_error &) {
+            group_threw = true;
+        }
+
+        std::cout << "exception propagation: "
+            << (future_threw && group_threw && tasks_run == 100 ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // task_groups can be nested - a worker waiting for a group runs other tasks
+        // (including the group's) rather than blocking, so this can't deadlock, even
+        // with far more waiting tasks than workers:
+        thread_pool pool;
+
+        std::function<long long(int)> fib = [&pool, &fib](int n) -> long long {
+            if (n < 2) { return n; }
+            long long a, b;
+            task_group group(pool);
+            group.run([&fib, &a, n]() { a = fib(n - 1); });
+            b = fib(n - 2);
+            group.wait();
+            return a + b;
+        };
+
+        task_future<long long> result = pool.submit([&fib]() { return fib(25); });
+        std::cout << "nested task groups: " << (result.get() == 75025 ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        // run_tasks_and_wait runs each index exactly once (and nothing at all for 0 tasks):
+        thread_pool pool;
+
+        std::vector<std::atomic<int>> runs(50);
+        run_tasks_and_wait(pool, runs.size(), [&runs](int i) { runs[i]++; });
+        bool each_once = std::all_of(runs.begin(), runs.end(), [](const std::atomic<int> &count) { return count == 1; });
+
+        bool none_run = true;
+        run_tasks_and_wait(pool, 0, [&none_run](int) { none_run = false; });
+        run_tasks_and_wait(pool, -1, [&none_run](int) { none_run = false; });
+
+        std::cout << "run tasks and wait: " << (each_once && none_run ? "passed" : "FAILED") << "\n";
+
+    }
+
+    {
+
+        thread_pool pool;
+        const int size = 1000003;
+        std::vector<long long> values(size);
+        std::iota(values.begin(), values.end(), 1);
+
+        std::vector<long long> doubled(size);
+        parallel_for(pool, 0, size, [&values, &doubled](int i) { doubled[i] = 2 * values[i]; });
+        bool for_passed = std::equal(values.begin(), values.end(), doubled.begin(),
+            [](long long value, long long doubled) { return doubled == 2 * value; });
+
+        long long sum = parallel_reduce(pool, 0, size, 0LL,
+            [&values](int i) { return values[i]; }, std::plus<long long>());
+        bool reduce_passed = sum == static_cast<long long>(size) * (size + 1) / 2;
+
+        // (combine only has to be associative, so the pieces must be combined in order):
+        std::string letters = parallel_reduce(pool, 0, 5000, std::string(),
+            [](int i) { return std::string(1, 'a' + i % 26); },
+            [](std::string left, const std::string &right) { return left + right; }, 100);
+        bool in_order = true;
+        for (int i = 0; i < 5000; i++) {
+            in_order = in_order && letters[i] == 'a' + i % 26;
+        }
 
-        std::cout << "done...\n";
+        std::vector<long long> plus_one(size);
+        parallel_transform(pool, values.begin(), values.end(), plus_one.begin(), [](long long value) { return value + 1; });
+        bool transform_passed = plus_one[0] == 2 && plus_one[size - 1] == size + 1;
+
+        std::vector<long long> expected(size);
+        std::inclusive_scan(values.begin(), values.end(), expected.begin());
+        parallel_inclusive_scan(pool, values.begin(), values.end(), values.begin(), std::plus<long long>(), 1000);
+        bool scan_passed = values == expected;
+
+        std::cout << "parallel algorithms: "
+            << (for_passed && reduce_passed && in_order && transform_passed && scan_passed ? "passed" : "FAILED") << "\n";
+
+        // with a fixed grain size, floats are summed in the same order whatever the
+        // pool's size, so the result is the same too:
+        std::vector<float> fractions(size);
+        for (int i = 0; i < size; i++) { fractions[i] = 1.0f / (1 + i % 1000); }
+        auto sum_fractions = [&fractions](thread_pool &pool) {
+            return parallel_reduce(pool, 0, size, 0.0f,
+                [&fractions](int i) { return fractions[i]; }, std::plus<float>(), 4096);
+        };
+        thread_pool bigger_pool(pool.get_thread_count() + 3);
+        std::cout << "deterministic reduce: " << (sum_fractions(pool) == sum_fractions(bigger_pool) ? "passed" : "FAILED") << "\n";
 
     }
 
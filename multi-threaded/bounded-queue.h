@@ -0,0 +1,284 @@
+
+// a fixed capacity, lock-free, multi-producer multi-consumer queue - Dmitry Vyukov's
+// bounded queue (ref: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue),
+// with the same push/try_and_pop/wait_and_pop/finish interface as threadsafe_queue.
+// the items live in a ring buffer that's allocated once, up front. each slot has a
+// sequence number, which says whose turn it is: a producer claims the slot at
+// enqueue_position when it's sequence is enqueue_position (i.e. it's empty, and the
+// consumers have finished with it), and a consumer claims the slot at dequeue_position
+// when it's sequence is dequeue_position + 1 (i.e. it's been filled). so producers
+// and consumers only contend on their own position (with one CAS each), and the slot
+// itself is handed over by it's sequence, rather than by a lock.
+// push blocks whilst the queue is full, and wait_and_pop whilst it's empty. they only
+// fall back to a mutex and condition variable to sleep (and the other side only
+// touches it if someone's sleeping), so they stay lock-free whenever there's work.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+// how many times push and wait_and_pop retry (yielding in between) before they
+// go to sleep, since a short wait is usually all that's needed when there's work:
+constexpr int bounded_queue_spin_count = 16;
+
+template <typename T>
+class bounded_queue {
+
+public:
+
+    // NB: capacity is rounded up to a power of 2:
+    explicit bounded_queue(int capacity = 1024) {
+
+        std::size_t size = 2;
+        while (size < static_cast<std::size_t>(capacity)) { size <<= 1; }
+
+        mask = size - 1;
+        slots.reset(new slot[size]);
+        for (std::size_t i = 0; i < size; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+    }
+
+    ~bounded_queue() {
+
+        std::size_t end = enqueue_position.load(std::memory_order_relaxed);
+        for (std::size_t i = dequeue_position.load(std::memory_order_relaxed); i != end; i++) {
+            std::launder(reinterpret_cast<T*>(slots[i & mask].storage))->~T();
+        }
+
+    }
+
+    // pushes value if there's room, otherwise returns false (leaving value as it was):
+    bool try_push(T &value) {
+
+        std::size_t position = enqueue_position.load(std::memory_order_relaxed);
+        slot *claimed;
+
+        while (true) {
+
+            claimed = &slots[position & mask];
+            std::size_t sequence = claimed->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (difference == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // the slot's still holding the item from the last time round:
+                return false;
+            } else {
+                // another producer got here first:
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+
+        }
+
+        new (claimed->storage) T(std::move(value));
+        claimed->sequence.store(position + 1, std::memory_order_release);
+
+        if (num_waiting_consumers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard lock(wait_mutex);
+            is_empty.notify_one();
+        }
+
+        return true;
+
+    }
+
+    // pushes value, waiting for there to be room if the queue's full:
+    void push(T value) {
+
+        if (finished.load(std::memory_order_relaxed)) { throw; }
+
+        for (int i = 0; i < bounded_queue_spin_count; i++) {
+            if (try_push(value)) { return; }
+            std::this_thread::yield();
+        }
+
+        while (true) {
+
+            // NB: announcing that we're waiting before checking the positions, so that
+            // any consumer that moves dequeue_position after we've looked at it will
+            // see that someone's waiting (or, if it moves it before, we'll see that):
+            num_waiting_producers.fetch_add(1, std::memory_order_seq_cst);
+            std::size_t dequeued = dequeue_position.load(std::memory_order_seq_cst);
+            std::size_t enqueued = enqueue_position.load(std::memory_order_seq_cst);
+
+            if (try_push(value)) {
+                num_waiting_producers.fetch_sub(1, std::memory_order_seq_cst);
+                return;
+            }
+
+            if (enqueued - dequeued > mask) {
+                // properly full, so sleep until a consumer takes something:
+                std::unique_lock lock(wait_mutex);
+                is_full.wait(lock, [this, dequeued]() {
+                    return dequeue_position.load(std::memory_order_seq_cst) != dequeued;
+                });
+            } else {
+                // a consumer has claimed a slot, but not finished with it yet:
+                std::this_thread::yield();
+            }
+
+            num_waiting_producers.fetch_sub(1, std::memory_order_seq_cst);
+
+        }
+
+    }
+
+    bool try_and_pop(T &return_value) {
+
+        std::size_t position = dequeue_position.load(std::memory_order_relaxed);
+        slot *claimed;
+
+        while (true) {
+
+            claimed = &slots[position & mask];
+            std::size_t sequence = claimed->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+            if (difference == 0) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // the slot hasn't been filled yet:
+                return false;
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+
+        }
+
+        T *value = std::launder(reinterpret_cast<T*>(claimed->storage));
+        return_value = std::move(*value);
+        value->~T();
+        // the slot is next used a lap later:
+        claimed->sequence.store(position + mask + 1, std::memory_order_release);
+
+        if (num_waiting_producers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard lock(wait_mutex);
+            is_full.notify_one();
+        }
+
+        return true;
+
+    }
+
+    // waits for an item, and returns false (without one) if the queue is
+    // empty and finished:
+    bool wait_and_pop(T &return_value) {
+
+        for (int i = 0; i < bounded_queue_spin_count; i++) {
+            if (try_and_pop(return_value)) { return true; }
+            std::this_thread::yield();
+        }
+
+        while (true) {
+
+            // NB: as in push, announcing that we're waiting before checking the positions:
+            num_waiting_consumers.fetch_add(1, std::memory_order_seq_cst);
+            std::size_t enqueued = enqueue_position.load(std::memory_order_seq_cst);
+            std::size_t dequeued = dequeue_position.load(std::memory_order_seq_cst);
+
+            if (try_and_pop(return_value)) {
+                num_waiting_consumers.fetch_sub(1, std::memory_order_seq_cst);
+                return true;
+            }
+
+            if (enqueued == dequeued) {
+
+                std::unique_lock lock(wait_mutex);
+                if (finished.load(std::memory_order_seq_cst)) {
+                    num_waiting_consumers.fetch_sub(1, std::memory_order_seq_cst);
+                    // NB: unlocking first, since try_and_pop takes wait_mutex to wake a
+                    // waiting producer:
+                    lock.unlock();
+                    return pop_remaining(return_value);
+                }
+                is_empty.wait(lock, [this, enqueued]() {
+                    return enqueue_position.load(std::memory_order_seq_cst) != enqueued
+                        || finished.load(std::memory_order_seq_cst);
+                });
+
+            } else {
+                // a producer has claimed a slot, but not filled it yet:
+                std::this_thread::yield();
+            }
+
+            num_waiting_consumers.fetch_sub(1, std::memory_order_seq_cst);
+
+        }
+
+    }
+
+    // mark that no more items will be added, so consumers know
+    // not to keep waiting/consuming
+    void finish() {
+
+        {
+            std::lock_guard lock(wait_mutex);
+            finished.store(true, std::memory_order_seq_cst);
+        }
+        is_empty.notify_all();
+
+    }
+
+    int capacity() const {
+        return mask + 1;
+    }
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+private:
+
+    // once the queue's finished, takes anything that was pushed just before (or
+    // whilst) it was finished, including items whose producers have claimed a slot
+    // but not filled it yet. returns false once there's nothing left. NB: a push
+    // that's still waiting for room when the queue empties may be left in it:
+    bool pop_remaining(T &return_value) {
+
+        while (true) {
+
+            if (try_and_pop(return_value)) { return true; }
+            if (enqueue_position.load(std::memory_order_seq_cst) == dequeue_position.load(std::memory_order_seq_cst)) {
+                return false;
+            }
+            std::this_thread::yield();
+
+        }
+
+    }
+
+    struct slot {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // NB: the positions are on separate cache lines from each other (and from
+    // everything else), since producers write one and consumers the other:
+    alignas(64) std::atomic<std::size_t> enqueue_position { 0 };
+    alignas(64) std::atomic<std::size_t> dequeue_position { 0 };
+    alignas(64) std::size_t mask;
+    std::unique_ptr<slot[]> slots;
+    std::atomic<bool> finished { false };
+
+    std::atomic<int> num_waiting_producers { 0 };
+    std::atomic<int> num_waiting_consumers { 0 };
+    std::mutex wait_mutex;
+    std::condition_variable is_empty;
+    std::condition_variable is_full;
+
+};
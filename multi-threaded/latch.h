@@ -20,8 +20,9 @@ public:
 
     void count_down() {
 
-        counter--;
-        if (counter == 0) {
+        // NB: checking the result of the decrement (rather than re-reading counter)
+        // so that only the thread that takes counter to 0 sets the promise:
+        if (--counter == 0) {
             latch_promise.set_value();
         }
 
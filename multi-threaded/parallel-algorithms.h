@@ -0,0 +1,214 @@
+
+// data-parallel loops over index ranges (and iterator ranges), built on a
+// thread_pool's task_groups:
+// - parallel_for(pool, first, last, body) runs body(i) for each i in [first, last);
+// - parallel_reduce combines map(i) over [first, last);
+// - parallel_transform is std::transform, and parallel_inclusive_scan is
+//   std::inclusive_scan.
+// a range is split in half, recursively (with one half run as a task, which idle
+// workers can steal, and the other run by the current thread), until the pieces are
+// no bigger than grain_size, and each piece is then run as a plain loop. the grain
+// size should be big enough that a piece is worth more than the cost of a task
+// (roughly a microsecond) - passing 0 picks one automatically, that splits the range
+// into about parallel_chunks_per_thread pieces per thread (which leaves enough
+// spare pieces to balance out uneven work), but never smaller than
+// parallel_min_grain_size. so for bodies that do a lot of work per index, it's
+// better to pass a small grain size (e.g. 1).
+// ranges no bigger than the grain size are just run as a loop on the calling thread,
+// without touching the pool at all.
+// since the pieces only depend on the range and the grain size, so does the order in
+// which parallel_reduce and parallel_inclusive_scan combine values - so with a fixed
+// grain size, the result (e.g. of summing floats) is the same every time, however
+// the work happens to be scheduled (and with an automatic one, for a given pool size).
+// these can be called from tasks (see task_group), and rethrow the first exception
+// that the body threw.
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+#include "./thread-pool.h"
+
+// how many pieces (per thread) an automatic grain size splits a range into:
+constexpr int parallel_chunks_per_thread = 8;
+
+// the smallest automatic grain size:
+constexpr int parallel_min_grain_size = 1024;
+
+// the grain size to use for a range of size indices (grain_size, unless that's 0):
+int parallel_grain_size(thread_pool &pool, int size, int grain_size) {
+
+    if (grain_size > 0) { return grain_size; }
+
+    int num_pieces = parallel_chunks_per_thread * (pool.get_thread_count() + 1);
+    return std::max(parallel_min_grain_size, (size + num_pieces - 1) / num_pieces);
+
+}
+
+// calls body(piece_first, piece_last) for pieces of [first, last) no bigger than
+// grain_size (which must be > 0), splitting it in half recursively:
+template <typename RangeBody>
+void parallel_split(thread_pool &pool, int first, int last, int grain_size, const RangeBody &body) {
+
+    if (last - first <= grain_size) {
+        body(first, last);
+        return;
+    }
+
+    int middle = first + (last - first) / 2;
+
+    task_group group(pool);
+    group.run([&pool, middle, last, grain_size, &body]() {
+        parallel_split(pool, middle, last, grain_size, body);
+    });
+    parallel_split(pool, first, middle, grain_size, body);
+    group.wait();
+
+}
+
+// runs body(i) for every i in [first, last):
+template <typename Body>
+void parallel_for(thread_pool &pool, int first, int last, const Body &body, int grain_size = 0) {
+
+    if (last <= first) { return; }
+
+    grain_size = parallel_grain_size(pool, last - first, grain_size);
+
+    parallel_split(pool, first, last, grain_size, [&body](int piece_first, int piece_last) {
+        for (int i = piece_first; i < piece_last; i++) {
+            body(i);
+        }
+    });
+
+}
+
+// returns the combination of map(first), map(first + 1), ..., map(last - 1). each
+// piece is combined left to right, starting from identity, and then the pieces'
+// values are combined pairwise (keeping them in order) - so combine needs to be
+// associative, but not commutative:
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(thread_pool &pool, int first, int last, T identity,
+                    const Map &map, const Combine &combine, int grain_size = 0) {
+
+    if (last <= first) { return identity; }
+
+    grain_size = parallel_grain_size(pool, last - first, grain_size);
+
+    auto reduce_piece = [&identity, &map, &combine](int piece_first, int piece_last) {
+        T value = identity;
+        for (int i = piece_first; i < piece_last; i++) {
+            value = combine(std::move(value), map(i));
+        }
+        return value;
+    };
+
+    // (like parallel_split, but each half returns it's value, and the two halves
+    // are combined in order):
+    auto reduce_range = [&pool, grain_size, &combine, &reduce_piece](auto &self, int range_first, int range_last) -> T {
+
+        if (range_last - range_first <= grain_size) {
+            return reduce_piece(range_first, range_last);
+        }
+
+        int middle = range_first + (range_last - range_first) / 2;
+        std::optional<T> right;
+
+        task_group group(pool);
+        group.run([&self, &right, middle, range_last]() {
+            right.emplace(self(self, middle, range_last));
+        });
+        T left = self(self, range_first, middle);
+        group.wait();
+
+        return combine(std::move(left), std::move(*right));
+
+    };
+
+    return reduce_range(reduce_range, first, last);
+
+}
+
+// writes op(first[i]) to output[i] for each element of [first, last), and returns
+// the end of the output (as std::transform does). NB: the iterators have to be
+// random access, and output may be first:
+template <typename InputIt, typename OutputIt, typename UnaryOp>
+OutputIt parallel_transform(thread_pool &pool, InputIt first, InputIt last, OutputIt output,
+                            const UnaryOp &op, int grain_size = 0) {
+
+    int size = std::distance(first, last);
+
+    parallel_for(pool, 0, size, [first, output, &op](int i) {
+        output[i] = op(first[i]);
+    }, grain_size);
+
+    return output + size;
+
+}
+
+// writes the running combination of [first, last) to output (as std::inclusive_scan
+// does), and returns the end of the output. NB: as with parallel_transform, the
+// iterators have to be random access, and output may be first.
+// this takes three steps: each piece (bar the last) is reduced, the pieces' totals
+// are scanned on the calling thread, and then each piece is scanned, starting from
+// the total of the pieces before it. so each value's read twice, but every piece
+// can be worked on at once:
+template <typename InputIt, typename OutputIt, typename Combine>
+OutputIt parallel_inclusive_scan(thread_pool &pool, InputIt first, InputIt last, OutputIt output,
+                                    const Combine &combine, int grain_size = 0) {
+
+    using T = typename std::iterator_traits<InputIt>::value_type;
+
+    int size = std::distance(first, last);
+    if (size == 0) { return output; }
+
+    grain_size = parallel_grain_size(pool, size, grain_size);
+
+    auto scan_piece = [first, output, &combine](int piece_first, int piece_last, T value) {
+        output[piece_first] = value;
+        for (int i = piece_first + 1; i < piece_last; i++) {
+            value = combine(std::move(value), first[i]);
+            output[i] = value;
+        }
+    };
+
+    if (size <= grain_size) {
+        scan_piece(0, size, first[0]);
+        return output + size;
+    }
+
+    // piece p is [p * grain_size, (p + 1) * grain_size) (or up to size, for the last):
+    int num_pieces = (size + grain_size - 1) / grain_size;
+    auto piece_last = [size, grain_size](int piece) {
+        return static_cast<int>(std::min<long long>(static_cast<long long>(piece + 1) * grain_size, size));
+    };
+
+    // 1) the total of each piece (bar the last, which nothing comes after):
+    std::vector<std::optional<T>> totals(num_pieces - 1);
+    parallel_for(pool, 0, num_pieces - 1, [first, grain_size, &combine, &totals](int piece) {
+        int piece_first = piece * grain_size;
+        T value = first[piece_first];
+        for (int i = piece_first + 1; i < piece_first + grain_size; i++) {
+            value = combine(std::move(value), first[i]);
+        }
+        totals[piece].emplace(std::move(value));
+    }, 1);
+
+    // 2) turn them into the total of everything before each piece:
+    for (int piece = 1; piece < num_pieces - 1; piece++) {
+        totals[piece].emplace(combine(*totals[piece - 1], std::move(*totals[piece])));
+    }
+
+    // 3) scan each piece, starting from the total before it:
+    parallel_for(pool, 0, num_pieces, [first, grain_size, &combine, &totals, &scan_piece, &piece_last](int piece) {
+        int piece_first = piece * grain_size;
+        T value = piece == 0 ? first[0] : combine(*totals[piece - 1], first[piece_first]);
+        scan_piece(piece_first, piece_last(piece), std::move(value));
+    }, 1);
+
+    return output + size;
+
+}
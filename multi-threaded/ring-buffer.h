@@ -0,0 +1,128 @@
+
+// a growable circular buffer, with enough of std::deque's interface to be the
+// container of a std::queue. std::deque allocates (and frees) a block of memory
+// every few hundred bytes' worth of items that pass through it, whereas this only
+// allocates when it grows (doubling it's capacity), and never shrinks, so a queue
+// that's reached it's working size doesn't allocate at all.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+template <typename T>
+class ring_buffer {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    ring_buffer() = default;
+
+    ring_buffer(ring_buffer &&other) noexcept:
+        slots(std::move(other.slots)), capacity(other.capacity), head(other.head), count(other.count) {
+        other.capacity = other.head = other.count = 0;
+    }
+
+    ring_buffer& operator=(ring_buffer &&other) noexcept {
+
+        if (this != &other) {
+            clear();
+            slots = std::move(other.slots);
+            capacity = other.capacity;
+            head = other.head;
+            count = other.count;
+            other.capacity = other.head = other.count = 0;
+        }
+        return *this;
+
+    }
+
+    ~ring_buffer() {
+        clear();
+    }
+
+    void push_back(T value) {
+
+        if (count == capacity) { grow(); }
+        new (slot(head + count)) T(std::move(value));
+        count++;
+
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+
+        if (count == capacity) { grow(); }
+        T *value = new (slot(head + count)) T(std::forward<Args>(args)...);
+        count++;
+        return *value;
+
+    }
+
+    void pop_front() {
+
+        item(head)->~T();
+        head = (head + 1) & (capacity - 1);
+        count--;
+
+    }
+
+    T& front() { return *item(head); }
+    const T& front() const { return *item(head); }
+    T& back() { return *item(head + count - 1); }
+    const T& back() const { return *item(head + count - 1); }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void clear() {
+        while (count > 0) { pop_front(); }
+    }
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+
+private:
+
+    struct slot_storage {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::unique_ptr<slot_storage[]> slots;
+    // (always a power of 2, or 0):
+    std::size_t capacity = 0;
+    std::size_t head = 0;
+    std::size_t count = 0;
+
+    void* slot(std::size_t index) const {
+        return slots[index & (capacity - 1)].bytes;
+    }
+
+    T* item(std::size_t index) const {
+        return std::launder(reinterpret_cast<T*>(slot(index)));
+    }
+
+    void grow() {
+
+        std::size_t new_capacity = capacity == 0 ? 16 : 2 * capacity;
+        std::unique_ptr<slot_storage[]> new_slots(new slot_storage[new_capacity]);
+
+        for (std::size_t i = 0; i < count; i++) {
+            T *value = item(head + i);
+            new (new_slots[i].bytes) T(std::move(*value));
+            value->~T();
+        }
+
+        slots = std::move(new_slots);
+        capacity = new_capacity;
+        head = 0;
+
+    }
+
+};
@@ -0,0 +1,291 @@
+
+// a fixed capacity queue for exactly one producer thread and one consumer thread
+// (ref: https://rigtorp.se/ringbuffer/), with the same push/try_and_pop/wait_and_pop/
+// finish interface as threadsafe_queue. with only one thread on each side, neither
+// has to claim anything, so there are no atomic read-modify-writes at all - the
+// producer writes an item and then publishes it by storing write_index (with release
+// semantics), and the consumer reads it and then frees the slot by storing read_index.
+// each side also keeps a cached copy of the other's index, and only re-reads the real
+// one (pulling it's cache line over from the other core) when the cached copy says
+// the queue's full (or empty) - so whilst the queue's neither, the two sides don't
+// touch each other's cache lines at all, other than for the items themselves.
+// push_bulk and pop_bulk move a whole batch of items and then publish them with one
+// store, rather than one per item.
+// blocking waits spin (yielding) for a while, and then sleep on a condition variable.
+// a side that's going to sleep sets it's waiting flag before checking the other's
+// index one last time, and the other side checks the flag after storing it's index,
+// with a seq_cst fence in between on both sides - so either the sleeper sees the new
+// index, or the waker sees the flag (and takes the lock to wake it). the fence on the
+// fast path is the price of never missing a wake up.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+// how many times a blocking call retries (yielding in between) before it sleeps:
+constexpr int spsc_queue_spin_count = 64;
+
+template <typename T>
+class spsc_queue {
+
+public:
+
+    // NB: capacity is rounded up to a power of 2:
+    explicit spsc_queue(int capacity = 1024) {
+
+        std::size_t size = 2;
+        while (size < static_cast<std::size_t>(capacity)) { size <<= 1; }
+
+        mask = size - 1;
+        slots.reset(new slot[size]);
+
+    }
+
+    ~spsc_queue() {
+
+        std::size_t end = write_index.load(std::memory_order_relaxed);
+        for (std::size_t i = read_index.load(std::memory_order_relaxed); i != end; i++) {
+            item(i)->~T();
+        }
+
+    }
+
+    // (producer) pushes value if there's room, otherwise returns false (leaving value as it was):
+    bool try_push(T &value) {
+
+        std::size_t write = write_index.load(std::memory_order_relaxed);
+        if (write - cached_read_index > mask) {
+            cached_read_index = read_index.load(std::memory_order_acquire);
+            if (write - cached_read_index > mask) { return false; }
+        }
+
+        new (slots[write & mask].storage) T(std::move(value));
+        write_index.store(write + 1, std::memory_order_release);
+        wake(consumer_waiting, is_empty);
+
+        return true;
+
+    }
+
+    // (producer) pushes value, waiting for there to be room if the queue's full:
+    void push(T value) {
+
+        if (finished.load(std::memory_order_relaxed)) { throw; }
+
+        std::size_t write = write_index.load(std::memory_order_relaxed);
+        wait_for_room(write);
+
+        new (slots[write & mask].storage) T(std::move(value));
+        write_index.store(write + 1, std::memory_order_release);
+        wake(consumer_waiting, is_empty);
+
+    }
+
+    // (producer) pushes [first, last), waiting for room as needed, and publishing as
+    // many items at once as there's room for:
+    template <typename InputIt>
+    void push_bulk(InputIt first, InputIt last) {
+
+        if (finished.load(std::memory_order_relaxed)) { throw; }
+
+        std::size_t write = write_index.load(std::memory_order_relaxed);
+
+        while (first != last) {
+
+            wait_for_room(write);
+
+            std::size_t end = cached_read_index + mask + 1;
+            for (; first != last && write != end; ++first, ++write) {
+                new (slots[write & mask].storage) T(std::move(*first));
+            }
+
+            write_index.store(write, std::memory_order_release);
+            wake(consumer_waiting, is_empty);
+
+        }
+
+    }
+
+    // (consumer)
+    bool try_and_pop(T &return_value) {
+
+        std::size_t read = read_index.load(std::memory_order_relaxed);
+        if (read == cached_write_index) {
+            cached_write_index = write_index.load(std::memory_order_acquire);
+            if (read == cached_write_index) { return false; }
+        }
+
+        pop_at(read, return_value);
+        read_index.store(read + 1, std::memory_order_release);
+        wake(producer_waiting, is_full);
+
+        return true;
+
+    }
+
+    // (consumer) waits for an item, and returns false (without one) if the
+    // queue is empty and finished:
+    bool wait_and_pop(T &return_value) {
+
+        std::size_t read = read_index.load(std::memory_order_relaxed);
+        if (!wait_for_items(read)) { return false; }
+
+        pop_at(read, return_value);
+        read_index.store(read + 1, std::memory_order_release);
+        wake(producer_waiting, is_full);
+
+        return true;
+
+    }
+
+    // (consumer) waits for at least one item, and then pops up to max_items of them
+    // into output, freeing up their slots all at once. returns how many were popped
+    // (so 0 if the queue is empty and finished):
+    template <typename OutputIt>
+    int pop_bulk(OutputIt output, int max_items) {
+
+        std::size_t read = read_index.load(std::memory_order_relaxed);
+        if (max_items <= 0 || !wait_for_items(read)) { return 0; }
+
+        int count = std::min<std::size_t>(cached_write_index - read, max_items);
+        for (int i = 0; i < count; i++, ++output) {
+            pop_at(read + i, *output);
+        }
+
+        read_index.store(read + count, std::memory_order_release);
+        wake(producer_waiting, is_full);
+
+        return count;
+
+    }
+
+    // mark that no more items will be added, so the consumer knows
+    // not to keep waiting/consuming
+    void finish() {
+
+        {
+            std::lock_guard lock(wait_mutex);
+            finished.store(true, std::memory_order_release);
+        }
+        is_empty.notify_all();
+
+    }
+
+    int capacity() const {
+        return mask + 1;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+private:
+
+    struct slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // NB: each index, and each side's cached copy of the other's index, is on it's
+    // own cache line:
+    alignas(64) std::atomic<std::size_t> write_index { 0 };
+    alignas(64) std::size_t cached_read_index = 0;
+    alignas(64) std::atomic<std::size_t> read_index { 0 };
+    alignas(64) std::size_t cached_write_index = 0;
+    alignas(64) std::size_t mask;
+    std::unique_ptr<slot[]> slots;
+    std::atomic<bool> finished { false };
+
+    std::atomic<bool> producer_waiting { false };
+    std::atomic<bool> consumer_waiting { false };
+    std::mutex wait_mutex;
+    std::condition_variable is_empty;
+    std::condition_variable is_full;
+
+    T* item(std::size_t index) {
+        return std::launder(reinterpret_cast<T*>(slots[index & mask].storage));
+    }
+
+    template <typename Output>
+    void pop_at(std::size_t index, Output &output) {
+        T *value = item(index);
+        output = std::move(*value);
+        value->~T();
+    }
+
+    // (called after storing an index):
+    void wake(std::atomic<bool> &waiting, std::condition_variable &condition) {
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(wait_mutex);
+            condition.notify_one();
+        }
+
+    }
+
+    // (producer) waits until there's room for the item at write:
+    void wait_for_room(std::size_t write) {
+
+        auto has_room = [this, write]() {
+            if (write - cached_read_index <= mask) { return true; }
+            cached_read_index = read_index.load(std::memory_order_acquire);
+            return write - cached_read_index <= mask;
+        };
+
+        for (int i = 0; i < spsc_queue_spin_count; i++) {
+            if (has_room()) { return; }
+            std::this_thread::yield();
+        }
+
+        producer_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(wait_mutex);
+            is_full.wait(lock, has_room);
+        }
+        producer_waiting.store(false, std::memory_order_relaxed);
+
+    }
+
+    // (consumer) waits until there's an item at read, returning false if the queue
+    // is finished (and there isn't one):
+    bool wait_for_items(std::size_t read) {
+
+        auto has_items = [this, read]() {
+            if (read != cached_write_index) { return true; }
+            cached_write_index = write_index.load(std::memory_order_acquire);
+            return read != cached_write_index;
+        };
+
+        for (int i = 0; i < spsc_queue_spin_count; i++) {
+            if (has_items()) { return true; }
+            std::this_thread::yield();
+        }
+
+        consumer_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool found;
+        {
+            // NB: finished is checked before looking for items one last time, so that
+            // (since finish comes after the last push) the last items are seen:
+            std::unique_lock lock(wait_mutex);
+            is_empty.wait(lock, [this, &has_items, &found]() {
+                bool is_finished = finished.load(std::memory_order_acquire);
+                found = has_items();
+                return found || is_finished;
+            });
+        }
+        consumer_waiting.store(false, std::memory_order_relaxed);
+
+        return found;
+
+    }
+
+};
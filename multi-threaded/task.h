@@ -0,0 +1,135 @@
+
+// a move-only, type-erased void() callable - like std::function<void()>, but since
+// it never has to be copied, it can hold move-only callables (e.g. lambdas that
+// capture a std::unique_ptr or a std::promise). callables of up to task_inline_size
+// bytes (that can be moved without throwing) are stored inline, so making, moving
+// and running one doesn't allocate - which std::function only manages for very
+// small captures (16 bytes with libstdc++). bigger callables go on the heap.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+constexpr std::size_t task_inline_size = 64;
+
+class task {
+
+public:
+
+    task() noexcept = default;
+
+    template <typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, task>>>
+    task(Function &&function) {
+
+        using stored = std::decay_t<Function>;
+
+        if constexpr (is_inline<stored>) {
+            new (storage) stored(std::forward<Function>(function));
+            operations = &inline_operations<stored>;
+        } else {
+            new (storage) stored*(new stored(std::forward<Function>(function)));
+            operations = &heap_operations<stored>;
+        }
+
+    }
+
+    task(task &&other) noexcept {
+        move_from(other);
+    }
+
+    task& operator=(task &&other) noexcept {
+
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+
+    }
+
+    ~task() {
+        reset();
+    }
+
+    // NB: mustn't be empty:
+    void operator()() {
+        operations->invoke(storage);
+    }
+
+    explicit operator bool() const noexcept {
+        return operations != nullptr;
+    }
+
+    // destroys the callable (and whatever it's captured), leaving the task empty:
+    void reset() noexcept {
+
+        if (operations) {
+            operations->destroy(storage);
+            operations = nullptr;
+        }
+
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+private:
+
+    struct operation_table {
+        void (*invoke)(void *storage);
+        // moves the callable from one storage to another, destroying the original:
+        void (*relocate)(void *from, void *to) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <typename Function>
+    static constexpr bool is_inline = sizeof(Function) <= task_inline_size
+        && alignof(Function) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible_v<Function>;
+
+    template <typename Function>
+    static Function* inline_function(void *storage) {
+        return std::launder(reinterpret_cast<Function*>(storage));
+    }
+
+    template <typename Function>
+    static Function*& heap_function(void *storage) {
+        return *std::launder(reinterpret_cast<Function**>(storage));
+    }
+
+    template <typename Function>
+    static constexpr operation_table inline_operations = {
+        [](void *storage) { (*inline_function<Function>(storage))(); },
+        [](void *from, void *to) noexcept {
+            Function *function = inline_function<Function>(from);
+            new (to) Function(std::move(*function));
+            function->~Function();
+        },
+        [](void *storage) noexcept { inline_function<Function>(storage)->~Function(); }
+    };
+
+    // (only the pointer is stored inline, so only the pointer has to be moved):
+    template <typename Function>
+    static constexpr operation_table heap_operations = {
+        [](void *storage) { (*heap_function<Function>(storage))(); },
+        [](void *from, void *to) noexcept { new (to) Function*(heap_function<Function>(from)); },
+        [](void *storage) noexcept { delete heap_function<Function>(storage); }
+    };
+
+    alignas(std::max_align_t) unsigned char storage[task_inline_size];
+    const operation_table *operations = nullptr;
+
+    void move_from(task &other) noexcept {
+
+        if (other.operations) {
+            other.operations->relocate(other.storage, storage);
+            operations = other.operations;
+            other.operations = nullptr;
+        }
+
+    }
+
+};
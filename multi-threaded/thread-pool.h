@@ -1,14 +1,123 @@
 
-// TODO: exception handling for tasks!!
-// currently, if task throws, then exception isn't caught by worker and 
-// therefore the thread will call std::terminate
-// TODO: add waiting for tasks to finish - right now this is more or less 
-// just fire and forget
+#pragma once
 
 #include <thread>
 #include <vector>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <optional>
+#include <type_traits>
 
 #include "./threadsafe-queue.h"
+#include "./work-stealing-deque.h"
+#include "./task.h"
+#include "../helpers/random.h"
+
+// a work stealing thread pool (ref: https://en.wikipedia.org/wiki/Work_stealing).
+// rather than every submit and every worker going through one queue (and one
+// mutex), each worker has it's own work_stealing_deque:
+// - tasks submitted by a task that's running on one of the pool's workers go onto
+//   that worker's deque, without any locking, and the worker then runs them (most
+//   recent first) once it's done with the current task;
+// - tasks submitted from outside the pool go onto a global 'injection' queue;
+// - a worker with nothing on it's own deque takes a batch of (up to
+//   thread_pool_batch_size) tasks from the injection queue, runs the first, and
+//   puts the rest on it's deque (where the others can steal them). failing that,
+//   it steals the oldest task from another worker's deque, trying the others in
+//   turn, starting from one picked at random (so thieves spread out over the
+//   victims rather than all going for the same one);
+// - a worker that can't find anything at all goes to sleep until more work is
+//   submitted.
+// so with fine-grained (e.g. divide and conquer) work, workers mostly stay on their
+// own deques, and only contend with each other when one of them runs dry.
+// tasks are held as a (move-only) task, so small ones don't allocate. since deques
+// can only hold pointers, each worker keeps a free list of the nodes that tasks on
+// it's deque are held in. nodes that are stolen are handed back to the worker they
+// came from (with a lock-free push onto it's returned_nodes list), so once there
+// are enough nodes to go round, submitting a task doesn't allocate at all.
+// there are three ways of waiting for work to finish:
+// - submit returns a task_future, which holds the task's result (or the exception
+//   it threw);
+// - a task_group runs any number of tasks, and then waits for all of them (and
+//   rethrows the first exception that any of them threw);
+// - wait_idle waits until the pool has nothing left to do at all.
+// a worker that waits for a task_future or a task_group doesn't just block - it runs
+// other pending tasks in the meantime (quite likely including the ones it's waiting
+// for), so tasks can wait for tasks that they've submitted without tying up a worker
+// (or deadlocking, once every worker is waiting). when there's nothing to run, it
+// sleeps as an idle worker does, so that new work wakes it too.
+// each future and task_group has it's own wait word, and only wakes the pool's
+// waiters if something marked it as waited for, so finishing a task that nothing's
+// blocked on doesn't touch anything shared.
+// NB: tasks from submit_detached and submit_bulk mustn't throw - as with a
+// std::thread, an exception escaping one of them calls std::terminate.
+
+// the most tasks a worker takes from the injection queue at once:
+constexpr int thread_pool_batch_size = 32;
+
+// how many task nodes a worker allocates at a time, when it runs out:
+constexpr int thread_pool_node_block_size = 64;
+
+// how many freed allocations each thread keeps for reuse, in an allocation_cache:
+constexpr int allocation_cache_size = 256;
+
+// keeps up to allocation_cache_size freed allocations of sizeof(T) per thread for
+// reuse, so that (once it's warmed up) making and freeing Ts doesn't allocate:
+template <typename T>
+class allocation_cache {
+
+public:
+
+    static void* allocate() {
+
+        std::vector<void*> &cache = get_cache();
+        if (cache.empty()) { return ::operator new(sizeof(T)); }
+
+        void *allocation = cache.back();
+        cache.pop_back();
+        return allocation;
+
+    }
+
+    static void deallocate(void *allocation) {
+
+        std::vector<void*> &cache = get_cache();
+        if (static_cast<int>(cache.size()) < allocation_cache_size) {
+            cache.push_back(allocation);
+        } else {
+            ::operator delete(allocation);
+        }
+
+    }
+
+private:
+
+    struct cached_allocations {
+        std::vector<void*> allocations;
+        ~cached_allocations() {
+            for (void *allocation : allocations) { ::operator delete(allocation); }
+        }
+    };
+
+    static std::vector<void*>& get_cache() {
+        thread_local cached_allocations cache;
+        return cache.allocations;
+    }
+
+};
+
+template <typename Result>
+class future_state;
+
+template <typename Result>
+class task_future;
 
 class thread_pool {
 
@@ -18,10 +127,15 @@ public:
 
         num_threads = std::max(num_threads, 1);
 
+        // NB: all of the deques need to exist before any worker starts stealing:
+        for (int i = 0; i < num_threads; i++) {
+            workers.push_back(std::make_unique<worker_state>(i));
+        }
+
         for (int i = 0; i < num_threads; i++) {
 
             try {
-                threads.emplace_back(&thread_pool::worker, this);
+                threads.emplace_back(&thread_pool::worker, this, i);
             } catch (...) {
                 clean_up();
                 throw;
@@ -36,9 +150,153 @@ public:
 
     }
 
-    void submit(std::function<void()> task) {
+    // runs function on the pool, and returns a task_future for it's result:
+    template <typename Function, typename Result = std::invoke_result_t<std::decay_t<Function>&>>
+    task_future<Result> submit(Function &&function) {
+
+        future_state<Result> *state = future_state<Result>::create(*this);
+
+        submit_detached([state, function = std::forward<Function>(function)]() mutable {
+            state->run(function);
+            future_state<Result>::release(state);
+        });
+
+        return task_future<Result>(state);
+
+    }
+
+    // runs work on the pool, with no way of waiting for it (other than wait_idle):
+    void submit_detached(task work) {
+
+        if (current_pool == this) {
+            worker_state &state = *workers[current_worker];
+            count_submitted(state, 1);
+            push_local(state, std::move(work));
+        } else {
+            external_submitted.fetch_add(1, std::memory_order_seq_cst);
+            injection_queue.push(std::move(work));
+        }
+
+        notify_work(1);
+
+    }
+
+    // submits all of the tasks in [first, last) at once (so from outside the pool,
+    // they go onto the injection queue under one lock), and wakes as many sleeping
+    // workers as there are tasks:
+    template <typename InputIt>
+    void submit_bulk(InputIt first, InputIt last) {
+
+        int count = std::distance(first, last);
+        if (count == 0) { return; }
+
+        if (current_pool == this) {
+            worker_state &state = *workers[current_worker];
+            count_submitted(state, count);
+            for (; first != last; ++first) {
+                push_local(state, std::move(*first));
+            }
+        } else {
+            external_submitted.fetch_add(count, std::memory_order_seq_cst);
+            injection_queue.push_bulk(first, last);
+        }
+
+        notify_work(count);
+
+    }
+
+    // waits until everything that's been submitted (including everything submitted
+    // by those tasks, and so on) has finished.
+    // NB: this mustn't be called from a task running on the pool, since the pool
+    // can't be idle until that task's finished:
+    void wait_idle() {
+
+        // NB: (as with sleeping workers) announcing that we're waiting before checking
+        // is_idle, so that either we see the pool idle, or the worker that leaves it
+        // idle sees us waiting (when it runs out of work) and wakes us:
+        idle_waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(sleep_mutex);
+            num_waiting_threads++;
+            task_finished.wait(lock, [this]() { return is_idle(); });
+            num_waiting_threads--;
+        }
+        idle_waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+    }
+
+    // waits for waitable (a future_state or task_group) of one of this pool's tasks:
+    // - waitable.is_done() returns whether it's done;
+    // - waitable.mark_waiting() marks that there's a waiter (so that whatever makes it
+    //   done calls notify_waiters), and returns whether it's already done.
+    // one of the pool's workers runs other pending tasks whilst it waits, and when
+    // there aren't any, sleeps as an idle worker does - so it's woken by new work
+    // (which it then helps with), as well as by waitable being done. any other
+    // thread just sleeps:
+    template <typename Waitable>
+    void wait_for(Waitable &waitable) {
+
+        if (waitable.is_done()) { return; }
+
+        if (current_pool != this) {
+
+            if (waitable.mark_waiting()) { return; }
+
+            std::unique_lock lock(sleep_mutex);
+            num_waiting_threads++;
+            task_finished.wait(lock, [&waitable]() { return waitable.is_done(); });
+            num_waiting_threads--;
+            return;
+
+        }
+
+        worker_state &state = *workers[current_worker];
+        task work;
+        bool marked = false;
+
+        while (!waitable.is_done()) {
+
+            if (find_task(state, work)) {
+                run(state, work);
+                continue;
+            }
+
+            if (!marked) {
+                marked = true;
+                if (waitable.mark_waiting()) { return; }
+            }
+
+            num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            unsigned epoch = work_epoch.load(std::memory_order_seq_cst);
+
+            if (find_task(state, work)) {
+                num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                run(state, work);
+                continue;
+            }
+
+            {
+                std::unique_lock lock(sleep_mutex);
+                num_waiting_workers++;
+                work_available.wait(lock, [this, epoch, &waitable]() {
+                    return work_epoch.load(std::memory_order_seq_cst) != epoch || waitable.is_done();
+                });
+                num_waiting_workers--;
+            }
+            num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+
+        }
+
+    }
+
+    // wakes anything that's waiting (in wait_for) - called when a waitable that's been
+    // marked as waited for is done:
+    void notify_waiters() {
 
-        work_queue.push(task);
+        std::lock_guard lock(sleep_mutex);
+        if (num_waiting_workers > 0) { work_available.notify_all(); }
+        if (num_waiting_threads > 0) { task_finished.notify_all(); }
 
     }
 
@@ -51,12 +309,127 @@ public:
 
 private:
 
+    struct task_node {
+        task work;
+        // the worker whose free list it belongs to:
+        int owner;
+        task_node *next;
+    };
+
+    struct worker_state {
+
+        int index;
+        work_stealing_deque<task_node*> tasks;
+        // (only touched by the worker itself):
+        task_node *free_nodes = nullptr;
+        std::vector<std::unique_ptr<task_node[]>> node_blocks;
+        std::vector<task> batch;
+        xoshiro256_star_star generator;
+        // nodes that other workers have stolen, run, and handed back:
+        alignas(64) std::atomic<task_node*> returned_nodes { nullptr };
+        // how many tasks the worker has submitted, and how many it's run. only the
+        // worker itself writes them (so they don't need read-modify-writes), and
+        // they're only read by wait_idle:
+        alignas(64) std::atomic<long long> submitted { 0 };
+        std::atomic<long long> completed { 0 };
+
+        explicit worker_state(int index): index(index), generator(random_seed(), index) {
+            batch.reserve(thread_pool_batch_size);
+        }
+
+    };
+
     std::vector<std::thread> threads;
-    threadsafe_queue<std::function<void()>> work_queue;
+    std::vector<std::unique_ptr<worker_state>> workers;
+    threadsafe_queue<task> injection_queue;
+    // how many tasks have been submitted from outside of the pool:
+    std::atomic<long long> external_submitted { 0 };
+
+    // sleeping workers wait for work_epoch to change, which submit only does (and
+    // only takes sleep_mutex for) when there are any sleeping:
+    std::atomic<unsigned> work_epoch { 0 };
+    std::atomic<int> num_sleeping { 0 };
+    std::mutex sleep_mutex;
+    std::condition_variable work_available;
+    bool stopping = false;
+
+    // workers that are waiting in wait_for also sleep on work_available, and other
+    // threads that are waiting (in wait_for or wait_idle) sleep on task_finished.
+    // (these are only touched under sleep_mutex):
+    int num_waiting_workers = 0;
+    int num_waiting_threads = 0;
+    std::condition_variable task_finished;
+    // how many threads are in wait_idle:
+    std::atomic<int> idle_waiters { 0 };
+
+    // the pool (if any) that the current thread is a worker of, and which one:
+    static inline thread_local thread_pool *current_pool = nullptr;
+    static inline thread_local int current_worker = -1;
+
+    // (called after the tasks have been pushed). NB: the fence pairs with the one
+    // after a sleeping worker increments num_sleeping, so that either we see it
+    // sleeping, or it sees the tasks in it's last look for work. so whilst no one's
+    // sleeping, a submit doesn't write to anything shared at all:
+    void notify_work(int num_tasks) {
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        int sleeping = num_sleeping.load(std::memory_order_relaxed);
+        if (sleeping > 0) {
+            work_epoch.fetch_add(1, std::memory_order_seq_cst);
+            std::lock_guard lock(sleep_mutex);
+            if (num_tasks >= sleeping) {
+                work_available.notify_all();
+            } else {
+                for (int i = 0; i < num_tasks; i++) {
+                    work_available.notify_one();
+                }
+            }
+        }
+
+    }
+
+    static void count_submitted(worker_state &state, int count) {
+        state.submitted.store(state.submitted.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+    }
+
+    static void run(worker_state &state, task &work) {
+
+        work();
+        work.reset();
+        state.completed.store(state.completed.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+
+    }
+
+    // NB: the completed counts are read before the submitted ones. a task can only
+    // complete after it's been submitted, so every task that's counted as completed
+    // has also been counted as submitted, and the counts can only match if nothing's
+    // pending or running:
+    bool is_idle() const {
+
+        long long completed = 0;
+        for (const std::unique_ptr<worker_state> &state : workers) {
+            completed += state->completed.load(std::memory_order_seq_cst);
+        }
+
+        long long submitted = external_submitted.load(std::memory_order_seq_cst);
+        for (const std::unique_ptr<worker_state> &state : workers) {
+            submitted += state->submitted.load(std::memory_order_seq_cst);
+        }
+
+        return submitted == completed;
+
+    }
 
     void clean_up() {
 
-        work_queue.finish();
+        injection_queue.finish();
+
+        {
+            std::lock_guard lock(sleep_mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
 
         for (int i = 0, l = threads.size(); i < l; i++) {
             if (threads[i].joinable()) {
@@ -66,15 +439,431 @@ private:
 
     }
 
-    void worker() {
+    // NB: only the worker itself may push onto it's deque:
+    void push_local(worker_state &state, task work) {
+
+        if (!state.free_nodes) {
+            state.free_nodes = state.returned_nodes.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        if (!state.free_nodes) {
+            state.node_blocks.push_back(std::make_unique<task_node[]>(thread_pool_node_block_size));
+            task_node *block = state.node_blocks.back().get();
+            for (int i = 0; i < thread_pool_node_block_size; i++) {
+                block[i].owner = state.index;
+                block[i].next = i + 1 < thread_pool_node_block_size ? &block[i + 1] : nullptr;
+            }
+            state.free_nodes = block;
+        }
+
+        task_node *node = state.free_nodes;
+        state.free_nodes = node->next;
+        node->work = std::move(work);
+        state.tasks.push(node);
+
+    }
+
+    // moves the task out of node, and then hands node back to it's owner:
+    void take_from_node(worker_state &state, task_node *node, task &work) {
+
+        work = std::move(node->work);
+
+        worker_state &owner = *workers[node->owner];
+        if (&owner == &state) {
+            node->next = owner.free_nodes;
+            owner.free_nodes = node;
+        } else {
+            node->next = owner.returned_nodes.load(std::memory_order_relaxed);
+            while (!owner.returned_nodes.compare_exchange_weak(node->next, node,
+                    std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
+    }
+
+    bool find_task(worker_state &state, task &work) {
+
+        task_node *node;
+        if (state.tasks.take(node)) {
+            take_from_node(state, node, work);
+            return true;
+        }
+
+        std::vector<task> &batch = state.batch;
+        batch.clear();
+        int count = injection_queue.try_and_pop_bulk(std::back_inserter(batch), thread_pool_batch_size);
+        if (count > 0) {
+
+            // NB: pushing the rest in reverse, so that this worker (taking from the
+            // bottom) still runs them in the order they were submitted:
+            for (int i = count - 1; i > 0; i--) {
+                push_local(state, std::move(batch[i]));
+            }
+            if (count > 1) { notify_work(count - 1); }
+
+            work = std::move(batch[0]);
+            return true;
+
+        }
+
+        int num_workers = workers.size();
+        int first_victim = uniform_int(state.generator, num_workers);
+        for (int i = 0; i < num_workers; i++) {
+
+            int victim = (first_victim + i) % num_workers;
+            if (victim == state.index) { continue; }
+
+            if (workers[victim]->tasks.steal(node)) {
+                take_from_node(state, node, work);
+                return true;
+            }
+
+        }
+
+        return false;
+
+    }
+
+    void worker(int index) {
+
+        current_pool = this;
+        current_worker = index;
+        worker_state &state = *workers[index];
+        task work;
 
         while (true) {
-            std::function<void()> task;
-            bool more_work = work_queue.wait_and_pop(task);
-            if (!more_work) { break; }
-            task();
+
+            if (find_task(state, work)) {
+                run(state, work);
+                continue;
+            }
+
+            // the pool may have just become idle, so wake anything in wait_idle:
+            if (idle_waiters.load(std::memory_order_seq_cst) > 0) {
+                notify_waiters();
+            }
+
+            // NB: announcing that we're about to sleep before looking for work one last
+            // time, so that anything submitted after that look sees num_sleeping > 0
+            // (and changes work_epoch), and so wakes us:
+            num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            unsigned epoch = work_epoch.load(std::memory_order_seq_cst);
+
+            if (find_task(state, work)) {
+                num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                run(state, work);
+                continue;
+            }
+
+            std::unique_lock lock(sleep_mutex);
+            if (stopping) {
+                num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                break;
+            }
+            work_available.wait(lock, [this, epoch]() {
+                return stopping || work_epoch.load(std::memory_order_seq_cst) != epoch;
+            });
+            num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+
+        }
+
+    }
+
+};
+
+// the state shared by a task_future and the task it's the result of. both of them
+// release it, and whichever's last destroys it. status is the future's wait word:
+// the task sets it's ready bit, and a task_future that's about to sleep sets it's
+// waiting bit, so (since each of them sees whether the other's bit was already set)
+// the task only has to wake anyone if there's a waiter:
+template <typename Result>
+class future_state {
+
+public:
+
+    static future_state* create(thread_pool &pool) {
+        return new (allocation_cache<future_state>::allocate()) future_state(pool);
+    }
+
+    static void release(future_state *state) {
+
+        if (state->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state->~future_state();
+            allocation_cache<future_state>::deallocate(state);
+        }
+
+    }
+
+    // runs function, and keeps it's result (or the exception it threw):
+    template <typename Function>
+    void run(Function &function) {
+
+        try {
+            if constexpr (std::is_void_v<Result>) {
+                function();
+            } else {
+                value.emplace(function());
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        if (status.fetch_or(ready, std::memory_order_acq_rel) & waiting) {
+            pool.notify_waiters();
+        }
+
+    }
+
+    // (the waitable interface of thread_pool::wait_for):
+    bool is_done() const {
+        return status.load(std::memory_order_acquire) & ready;
+    }
+
+    bool mark_waiting() {
+        return status.fetch_or(waiting, std::memory_order_acq_rel) & ready;
+    }
+
+    thread_pool& get_pool() const {
+        return pool;
+    }
+
+    // NB: mustn't be called until it's ready:
+    Result get() {
+
+        if (exception) { std::rethrow_exception(exception); }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*value);
         }
 
     }
 
+private:
+
+    struct no_value {};
+
+    static constexpr int ready = 1;
+    static constexpr int waiting = 2;
+
+    thread_pool &pool;
+    std::atomic<int> status { 0 };
+    std::atomic<int> references { 2 };
+    std::exception_ptr exception;
+    std::optional<std::conditional_t<std::is_void_v<Result>, no_value, Result>> value;
+
+    explicit future_state(thread_pool &pool): pool(pool) {}
+    ~future_state() = default;
+
 };
+
+// the result of a task submitted to a thread_pool - like a std::future, but it's
+// state comes from an allocation_cache rather than being allocated by a std::promise.
+// NB: (like a std::future from a std::promise, but unlike one from std::async)
+// destroying it doesn't wait for the task, so it's fine to drop one whose result
+// isn't wanted:
+template <typename Result>
+class task_future {
+
+public:
+
+    task_future() noexcept = default;
+
+    explicit task_future(future_state<Result> *state) noexcept: state(state) {}
+
+    task_future(task_future &&other) noexcept: state(std::exchange(other.state, nullptr)) {}
+
+    task_future& operator=(task_future &&other) noexcept {
+
+        if (this != &other) {
+            reset();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+
+    }
+
+    ~task_future() {
+        reset();
+    }
+
+    bool valid() const noexcept {
+        return state != nullptr;
+    }
+
+    bool is_ready() const {
+        return state->is_done();
+    }
+
+    void wait() const {
+        state->get_pool().wait_for(*state);
+    }
+
+    // waits for the task, and then returns it's result (or rethrows the exception it
+    // threw). NB: like std::future::get, this can only be called once:
+    Result get() {
+
+        wait();
+
+        struct release_on_exit {
+            future_state<Result> *state;
+            ~release_on_exit() { future_state<Result>::release(state); }
+        } finished { std::exchange(state, nullptr) };
+
+        return finished.state->get();
+
+    }
+
+    task_future(const task_future&) = delete;
+    task_future& operator=(const task_future&) = delete;
+
+private:
+
+    future_state<Result> *state = nullptr;
+
+    void reset() {
+
+        if (state) {
+            future_state<Result>::release(state);
+            state = nullptr;
+        }
+
+    }
+
+};
+
+// structured fork/join: run submits tasks to the pool, and wait waits for all of them
+// to finish (running pending tasks whilst it does, when it's called from a worker),
+// and then rethrows the first exception that any of them threw. all it keeps is a
+// count of unfinished tasks, so there's nothing to allocate per task beyond what
+// submit_detached needs. the count is also the group's wait word - a waiter that's
+// about to sleep sets it's top bit, so the last task only wakes anyone if there's a
+// waiter (and decides that from it's decrement, so it never touches the group after
+// the count reaches 0).
+// NB: the destructor also waits (without rethrowing), so the tasks can't outlive
+// anything they've captured by reference:
+class task_group {
+
+public:
+
+    explicit task_group(thread_pool &pool): pool(pool) {}
+
+    ~task_group() {
+        pool.wait_for(*this);
+    }
+
+    template <typename Function>
+    void run(Function &&function) {
+
+        unfinished.fetch_add(1, std::memory_order_relaxed);
+        pool.submit_detached(wrap(std::forward<Function>(function)));
+
+    }
+
+    // runs function(0), function(1), ..., function(count - 1) as count tasks, all
+    // submitted at once. NB: function (which may well be a temporary) is copied (or
+    // moved) once, and the copy is shared by the tasks, and kept until the group's
+    // been waited for:
+    template <typename Function>
+    void run_indexed(int count, Function &&function) {
+
+        if (count <= 0) { return; }
+
+        auto shared_function = std::make_shared<std::decay_t<Function>>(std::forward<Function>(function));
+        const std::decay_t<Function> *indexed_function = shared_function.get();
+        {
+            std::lock_guard lock(group_mutex);
+            kept_functions.push_back(std::move(shared_function));
+        }
+
+        std::vector<task> tasks;
+        tasks.reserve(count);
+        for (int i = 0; i < count; i++) {
+            tasks.push_back(wrap([indexed_function, i]() { (*indexed_function)(i); }));
+        }
+
+        unfinished.fetch_add(count, std::memory_order_relaxed);
+        pool.submit_bulk(tasks.begin(), tasks.end());
+
+    }
+
+    void wait() {
+
+        pool.wait_for(*this);
+        // (so that the group can be reused):
+        unfinished.store(0, std::memory_order_relaxed);
+        kept_functions.clear();
+
+        if (exception) {
+            std::rethrow_exception(std::exchange(exception, nullptr));
+        }
+
+    }
+
+    // (the waitable interface of thread_pool::wait_for):
+    bool is_done() const {
+        return (unfinished.load(std::memory_order_acquire) & ~waiting) == 0;
+    }
+
+    bool mark_waiting() {
+        return (unfinished.fetch_or(waiting, std::memory_order_acq_rel) & ~waiting) == 0;
+    }
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+private:
+
+    static constexpr int waiting = 1 << 30;
+
+    thread_pool &pool;
+    std::atomic<int> unfinished { 0 };
+    std::mutex group_mutex;
+    std::exception_ptr exception;
+    // the functions passed to run_indexed:
+    std::vector<std::shared_ptr<void>> kept_functions;
+
+    template <typename Function>
+    task wrap(Function &&function) {
+
+        return [this, pool = &pool, function = std::forward<Function>(function)]() mutable {
+
+            try {
+                function();
+            } catch (...) {
+                std::lock_guard lock(group_mutex);
+                if (!exception) { exception = std::current_exception(); }
+            }
+
+            // NB: the group may be destroyed as soon as unfinished reaches 0, so this
+            // mustn't touch it afterwards:
+            if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == (waiting | 1)) {
+                pool->notify_waiters();
+            }
+
+        };
+
+    }
+
+};
+
+// runs function(0), function(1), ..., function(num_tasks - 1) and returns once
+// they've all completed, rethrowing the first exception that any of them threw. all
+// but one of the tasks are submitted to pool, and the last one is run on the calling
+// thread (which may be one of pool's workers). if num_tasks <= 0 it does nothing:
+void run_tasks_and_wait(thread_pool &pool, int num_tasks, const std::function<void(int)> &function) {
+
+    if (num_tasks <= 0) { return; }
+
+    // (NB: the group's waited for before function goes out of scope, so there's no
+    // need for it to keep a copy):
+    task_group group(pool);
+    group.run_indexed(num_tasks - 1, std::cref(function));
+
+    try {
+        function(num_tasks - 1);
+    } catch (...) {
+        group.wait();
+        throw;
+    }
+    group.wait();
+
+}
@@ -2,7 +2,6 @@
 // a threadsafe_queue - mainly built with the use-case of a work queue in mind
 
 // TODO: think about destructor - what will happen if it's called whilst threads are waiting?
-// TODO: maintain a count of waiting threads?
 // TODO: add flush member function that will block until the queue is empty, or until no 
 // threads are waiting? (NB: in the case of a work queue - this would only mean all work 
 // has been taken up by some thread, not that all work has completed)
@@ -11,8 +10,11 @@
 
 #include <queue>
 #include <mutex>
+#include <algorithm>
 #include <condition_variable>
 
+#include "./ring-buffer.h"
+
 template <typename T>
 class threadsafe_queue {
 
@@ -32,6 +34,32 @@ public:
 
     }
 
+    // pushes [first, last) under one lock, and then wakes as many waiting
+    // consumers as there are new items (or all of them, if there are fewer):
+    template <typename InputIt>
+    void push_bulk(InputIt first, InputIt last) {
+
+        int count = 0;
+        int waiting;
+        {
+            std::lock_guard lock(queue_mutex);
+            if (finished) { throw; }
+            for (; first != last; ++first, ++count) {
+                data_queue.push(std::move(*first));
+            }
+            waiting = num_waiting;
+        }
+
+        if (count >= waiting) {
+            is_empty.notify_all();
+        } else {
+            for (int i = 0; i < count; i++) {
+                is_empty.notify_one();
+            }
+        }
+
+    }
+
     bool try_and_pop(T &return_value) {
 
         std::lock_guard lock(queue_mutex);
@@ -50,7 +78,7 @@ public:
 
         std::unique_lock lock(queue_mutex);
 
-        is_empty.wait(lock, [this]() { return !data_queue.empty() || finished; });
+        wait_for_items(lock);
 
         if (data_queue.empty()) { return false; }
 
@@ -60,6 +88,27 @@ public:
 
     }
 
+    // pops up to max_items into output under one lock, and returns how many
+    // were popped (which is 0 if the queue's empty):
+    template <typename OutputIt>
+    int try_and_pop_bulk(OutputIt output, int max_items) {
+
+        std::lock_guard lock(queue_mutex);
+        return pop_up_to(output, max_items);
+
+    }
+
+    // waits for an item, and then pops up to max_items into output under one lock.
+    // returns how many were popped (so 0 if the queue is empty and finished):
+    template <typename OutputIt>
+    int pop_bulk(OutputIt output, int max_items) {
+
+        std::unique_lock lock(queue_mutex);
+        wait_for_items(lock);
+        return pop_up_to(output, max_items);
+
+    }
+
     // mark that no more items will be added, so consumers know 
     // not to keep waiting/consuming
     void finish() {
@@ -77,9 +126,33 @@ public:
 
 private:
 
-    std::queue<T> data_queue;
+    // NB: a ring_buffer rather than the default std::deque, so that a queue that
+    // items are passing through doesn't keep allocating and freeing blocks:
+    std::queue<T, ring_buffer<T>> data_queue;
     std::mutex queue_mutex;
     std::condition_variable is_empty;
     bool finished = false;
+    // how many consumers are waiting on is_empty:
+    int num_waiting = 0;
+
+    void wait_for_items(std::unique_lock<std::mutex> &lock) {
+
+        num_waiting++;
+        is_empty.wait(lock, [this]() { return !data_queue.empty() || finished; });
+        num_waiting--;
+
+    }
+
+    template <typename OutputIt>
+    int pop_up_to(OutputIt output, int max_items) {
+
+        int count = std::min<std::size_t>(std::max(max_items, 0), data_queue.size());
+        for (int i = 0; i < count; i++, ++output) {
+            *output = std::move(data_queue.front());
+            data_queue.pop();
+        }
+        return count;
+
+    }
 
 };
@@ -0,0 +1,152 @@
+
+// a Chase-Lev work stealing deque (ref: https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf,
+// with the memory orderings from https://fzn.fr/readings/ppopp13.pdf, except that the
+// seq_cst fences are folded into the operations either side of them - which costs the
+// same on x86, and which thread sanitizer understands). it has one
+// owner, which pushes and takes at the bottom (so it works through it's own tasks
+// most recent first, whilst they're still warm in it's cache), and any number of
+// thieves, which steal from the top (the oldest tasks, which for divide and conquer
+// work tend to be the biggest). the owner only has to synchronise with thieves when
+// they're both going for the last item, and is otherwise lock-free and wait-free.
+// the array grows when it's full. thieves may still be reading an old array when
+// it's replaced, so old arrays are kept until the deque is destroyed (since they
+// double in size each time, that's never more than the size of the current one).
+// NB: items are read by thieves before they know whether they've won them, so T
+// has to be trivially copyable (e.g. a pointer).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+template <typename T>
+class work_stealing_deque {
+
+    static_assert(std::is_trivially_copyable_v<T>, "work_stealing_deque items must be trivially copyable");
+
+public:
+
+    explicit work_stealing_deque(int capacity = 256) {
+
+        // the capacity must be a power of 2, so that indices can be masked:
+        std::int64_t size = 1;
+        while (size < capacity) { size <<= 1; }
+
+        arrays.push_back(std::make_unique<ring_array>(size));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+
+    }
+
+    // NB: only the owner may push:
+    void push(T value) {
+
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        ring_array *a = array.load(std::memory_order_relaxed);
+
+        if (b - t > a->size - 1) {
+            a = grow(a, b, t);
+        }
+
+        a->put(b, value);
+        bottom.store(b + 1, std::memory_order_release);
+
+    }
+
+    // takes the most recently pushed item. NB: only the owner may take:
+    bool take(T &return_value) {
+
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        ring_array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            // empty:
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        return_value = a->get(b);
+        if (t < b) { return true; }
+
+        // it's the last item, so race any thieves for it:
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+
+    }
+
+    // takes the least recently pushed item. fails if the deque is empty, or if
+    // another thread got to the item first:
+    bool steal(T &return_value) {
+
+        std::int64_t t = top.load(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_seq_cst);
+
+        if (t >= b) { return false; }
+
+        ring_array *a = array.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+
+        return_value = value;
+        return true;
+
+    }
+
+    // NB: only a snapshot, which may be out of date as soon as it's returned:
+    bool empty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+private:
+
+    struct ring_array {
+
+        std::int64_t size;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit ring_array(std::int64_t size): size(size), items(new std::atomic<T>[size]) {}
+
+        T get(std::int64_t index) const {
+            return items[index & (size - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T value) {
+            items[index & (size - 1)].store(value, std::memory_order_relaxed);
+        }
+
+    };
+
+    // NB: top and bottom are on separate cache lines, since thieves write one and
+    // the owner the other:
+    alignas(64) std::atomic<std::int64_t> top { 0 };
+    alignas(64) std::atomic<std::int64_t> bottom { 0 };
+    alignas(64) std::atomic<ring_array*> array;
+    // (only touched by the owner):
+    std::vector<std::unique_ptr<ring_array>> arrays;
+
+    ring_array* grow(ring_array *old_array, std::int64_t b, std::int64_t t) {
+
+        arrays.push_back(std::make_unique<ring_array>(old_array->size * 2));
+        ring_array *new_array = arrays.back().get();
+
+        for (std::int64_t i = t; i < b; i++) {
+            new_array->put(i, old_array->get(i));
+        }
+
+        array.store(new_array, std::memory_order_release);
+        return new_array;
+
+    }
+
+};
@@ -1,19 +1,15 @@
 
 #include <iostream>
 #include <chrono>
-#include <random>
+#include <string>
 #include <algorithm>
 
 #include "./disjoint-sets/disjoint-sets.h"
-#include "./helpers/weighted-coin.h"
+#include "./helpers/random.h"
 
-void randomise_sites(std::vector<bool> &grid, double open_site_probability) {
+void randomise_sites(std::vector<bool> &grid, double open_site_probability, xoshiro256_star_star &generator) {
 
-    weighted_coin coin(open_site_probability);
-    int gridSize = grid.size();
-    for (int i = 0; i < gridSize; i++) {
-        grid[i] = coin.toss();
-    }
+    fill_bernoulli(generator, grid.begin(), grid.end(), open_site_probability);
 
 }
 
@@ -60,7 +56,7 @@ void make_connections(const std::vector<bool> &grid, disjoint_sets &connections,
 
 }
 
-int main() {
+int main(int argc, char **argv) {
 
     // using disjoint-sets to model percolation.
     // basically, we have a grid of cells that can be open or closed, as well 
@@ -73,6 +69,11 @@ int main() {
     int grid_side_length = 1000;
     int num_trials = 25;
 
+    // the seed can be given on the command line, so that a run can be reproduced:
+    std::uint64_t seed = argc > 1 ? std::stoull(argv[1]) : random_seed();
+    xoshiro256_star_star generator(seed);
+    std::cout << "seed: " << seed << "\n";
+
     std::vector<bool> grid(grid_side_length * grid_side_length);
 
     // nodes 0 and 1 will represent top and bottom elements that connect to 
@@ -87,7 +88,7 @@ int main() {
 
         for (int i = 0; i < num_trials; i++) {
             // randomly open sites within the grid:
-            randomise_sites(grid, open_site_probability);
+            randomise_sites(grid, open_site_probability, generator);
             // use a disjoint sets data structure to model the paths of open sites 
             // through the grid (i.e. we connect neighbouring sites when they're both open)
             make_connections(grid, connections, grid_side_length);
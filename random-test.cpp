@@ -0,0 +1,222 @@
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <cstdint>
+#include <cmath>
+
+#include "./helpers/random.h"
+#include "./helpers/weighted-coin.h"
+
+// the first count outputs of generator:
+template <typename Generator>
+std::vector<std::uint64_t> outputs(Generator generator, int count) {
+
+    std::vector<std::uint64_t> values(count);
+    for (int i = 0; i < count; i++) { values[i] = generator(); }
+    return values;
+
+}
+
+// whether the same seed (and stream) always gives the same sequence, and different
+// seeds (or streams) give different ones:
+template <typename Generator>
+bool is_reproducible() {
+
+    return outputs(Generator(12345), 1000) == outputs(Generator(12345), 1000)
+        && outputs(Generator(12345, 3), 1000) == outputs(Generator(12345, 3), 1000)
+        && outputs(Generator(12345), 1000) != outputs(Generator(12346), 1000)
+        && outputs(Generator(12345), 1000) != outputs(Generator(12345, 1), 1000);
+
+}
+
+// whether a count of successes out of trials is within 5 standard deviations of
+// what a probability of p would give:
+bool is_close_to(long long successes, long long trials, double p) {
+
+    double expected = p * trials;
+    double deviation = std::sqrt(trials * p * (1 - p));
+    return std::abs(successes - expected) <= 5 * deviation + 1;
+
+}
+
+int main() {
+
+    // reproducibility
+
+    if (!is_reproducible<xoshiro256_star_star>() || !is_reproducible<wyrand>() || !is_reproducible<pcg32>()) {
+        std::cout << "reproducibility: FAILED!\n";
+        throw;
+    }
+    std::cout << "reproducibility: passed\n";
+
+
+    // streams
+
+    {
+
+        // each xoshiro256_star_star stream is the one before, jumped ahead:
+        xoshiro256_star_star jumped(777);
+        jumped.jump();
+        jumped.jump();
+        bool jump_passed = outputs(jumped, 1000) == outputs(xoshiro256_star_star(777, 2), 1000);
+
+        // and streams shouldn't share any values, or be correlated bit by bit:
+        const int count = 100000;
+        std::vector<std::vector<std::uint64_t>> streams;
+        for (int stream = 0; stream < 4; stream++) {
+            streams.push_back(outputs(xoshiro256_star_star(777, stream), count));
+        }
+
+        std::unordered_set<std::uint64_t> seen;
+        bool all_distinct = true;
+        for (const std::vector<std::uint64_t> &stream : streams) {
+            for (std::uint64_t value : stream) {
+                all_distinct = all_distinct && seen.insert(value).second;
+            }
+        }
+
+        long long matching_bits = 0;
+        for (int i = 0; i < count; i++) {
+            matching_bits += 64 - __builtin_popcountll(streams[0][i] ^ streams[1][i]);
+        }
+        bool uncorrelated = is_close_to(matching_bits, 64LL * count, 0.5);
+
+        // pcg32 streams are different sequences, even from the same seed:
+        bool pcg_streams_differ = outputs(pcg32(777, 0), 1000) != outputs(pcg32(777, 1), 1000);
+
+        if (!jump_passed || !all_distinct || !uncorrelated || !pcg_streams_differ) {
+            std::cout << "streams: FAILED!\n";
+            throw;
+        }
+        std::cout << "streams: passed\n";
+
+    }
+
+
+    // uniform_int and uniform_real
+
+    {
+
+        xoshiro256_star_star generator(42);
+
+        bool in_range = true;
+        for (std::uint32_t bound : { 1u, 2u, 3u, 7u, 1000u, (1u << 31) + 1, 0xffffffffu }) {
+            for (int i = 0; i < 100000; i++) {
+                in_range = in_range && uniform_int(generator, bound) < bound;
+            }
+        }
+
+        // every value in [0, bound) should turn up about as often as the others:
+        const int bound = 10;
+        const int draws = 1000000;
+        std::vector<long long> counts(bound, 0);
+        for (int i = 0; i < draws; i++) {
+            counts[uniform_int(generator, bound)]++;
+        }
+        bool uniform = std::all_of(counts.begin(), counts.end(), [](long long count) {
+            return is_close_to(count, draws, 1.0 / bound);
+        });
+
+        bool reals_in_range = true;
+        for (int i = 0; i < 100000; i++) {
+            double value = uniform_real(generator);
+            reals_in_range = reals_in_range && value >= 0.0 && value < 1.0;
+        }
+
+        if (!in_range || !uniform || !reals_in_range) {
+            std::cout << "uniform_int and uniform_real: FAILED!\n";
+            throw;
+        }
+        std::cout << "uniform_int and uniform_real: passed\n";
+
+    }
+
+
+    // filling ranges
+
+    {
+
+        // the fills should give the same values as calling the generator directly:
+        std::vector<std::uint64_t> filled(1000);
+        wyrand fill_generator(9);
+        fill_random(fill_generator, filled.begin(), filled.end());
+        bool fill_passed = filled == outputs(wyrand(9), 1000);
+
+        std::vector<double> reals(1000);
+        xoshiro256_star_star real_generator(9);
+        fill_uniform_real(real_generator, reals.begin(), reals.end());
+        xoshiro256_star_star check_generator(9);
+        for (double value : reals) {
+            fill_passed = fill_passed && value == uniform_real(check_generator);
+        }
+
+        xoshiro256_star_star generator(9);
+        const int count = 1000001;
+        std::vector<char> tosses(count);
+
+        fill_bernoulli(generator, tosses.begin(), tosses.end(), 0.0);
+        bool never = std::count(tosses.begin(), tosses.end(), 1) == 0;
+        fill_bernoulli(generator, tosses.begin(), tosses.end(), 1.0);
+        bool always = std::count(tosses.begin(), tosses.end(), 1) == count;
+        fill_bernoulli(generator, tosses.begin(), tosses.end(), 0.3);
+        bool biased = is_close_to(std::count(tosses.begin(), tosses.end(), 1), count, 0.3);
+
+        if (!fill_passed || !never || !always || !biased) {
+            std::cout << "fills: FAILED!\n";
+            throw;
+        }
+        std::cout << "fills: passed\n";
+
+    }
+
+
+    // weighted coins
+
+    {
+
+        const int count = 1000000;
+
+        // the same seed gives the same tosses:
+        weighted_coin first_coin(0.5, 2024);
+        weighted_coin second_coin(0.5, 2024);
+        bool reproducible = true;
+        for (int i = 0; i < 1000; i++) {
+            reproducible = reproducible && first_coin.toss() == second_coin.toss();
+        }
+
+        bool biased = true;
+        for (double probability : { 0.01, 0.25, 0.5, 0.9 }) {
+
+            weighted_coin coin(probability, 1);
+            long long heads = 0;
+            for (int i = 0; i < count; i++) { heads += coin.toss(); }
+
+            std::vector<bool> tosses(count);
+            coin.toss(tosses.begin(), tosses.end());
+            long long bulk_heads = std::count(tosses.begin(), tosses.end(), true);
+
+            biased = biased && is_close_to(heads, count, probability) && is_close_to(bulk_heads, count, probability);
+
+        }
+
+        // probabilities are clamped to [0, 1]:
+        weighted_coin never(-1.0, 1);
+        weighted_coin always(2.0, 1);
+        bool clamped = true;
+        for (int i = 0; i < 1000; i++) {
+            clamped = clamped && !never.toss() && always.toss();
+        }
+
+        if (!reproducible || !biased || !clamped) {
+            std::cout << "weighted coin: FAILED!\n";
+            throw;
+        }
+        std::cout << "weighted coin: passed\n";
+
+    }
+
+    std::cout << "all good... :)\n";
+
+}
@@ -0,0 +1,368 @@
+
+// benchmarks every sort in sort/ (along with std::sort and std::stable_sort as
+// baselines) over a range of array sizes and input distributions.
+// for each algorithm, distribution and size, the sort is run a few times untimed
+// (warmup), and then timed repetitions times, with the median, percentiles etc. of
+// those times reported. small arrays are sorted in batches (of enough copies to
+// make each timing at least batch_elements elements), so that the timings aren't
+// just timer resolution. every result is checked to be sorted.
+// the inputs are generated from a fixed seed, so runs are comparable.
+// usage: sort-benchmark [--min-size=N] [--max-size=N] [--repetitions=N] [--warmup=N]
+//                       [--algorithms=a,b,...] [--distributions=a,b,...]
+//                       [--format=table|csv|json] [--output=path]
+// e.g. sort-benchmark --max-size=100000000 --format=csv --output=results.csv
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "./sort/insertion-sort.h"
+#include "./sort/merge-sort.h"
+#include "./sort/heap-sort.h"
+#include "./sort/quick-sort.h"
+#include "./sort/intro-sort.h"
+#include "./sort/tim-sort.h"
+#include "./sort/radix-sort.h"
+#include "./sort/parallel-merge-sort.h"
+#include "./sort/parallel-sample-sort.h"
+#include "./helpers/random.h"
+#include "./helpers/timer.h"
+
+// every timing sorts at least this many elements in total (over a batch of copies):
+constexpr int batch_elements = 1 << 16;
+
+struct sort_algorithm {
+    std::string name;
+    std::function<void(std::vector<int>&)> sort;
+    // the largest size to run it on, for any distribution other than random (e.g.
+    // quick_sort goes quadratic, and recurses n deep, on sorted input):
+    long long max_patterned_size;
+    // the largest size to run it on at all:
+    long long max_size;
+};
+
+struct input_distribution {
+    std::string name;
+    std::function<void(std::vector<int>&, xoshiro256_star_star&)> generate;
+};
+
+struct benchmark_result {
+    std::string algorithm;
+    std::string distribution;
+    long long size;
+    int batch_size;
+    // the time to sort one array, for each repetition, in sorted order:
+    std::vector<double> times_ms;
+};
+
+std::vector<sort_algorithm> get_algorithms(thread_pool &pool) {
+
+    constexpr long long unlimited = 1LL << 62;
+    // (for the sorts that are quadratic on some inputs):
+    constexpr long long quadratic_limit = 1 << 14;
+
+    return {
+        { "insertion_sort", [](std::vector<int> &array) { insertion_sort(array); }, quadratic_limit, quadratic_limit },
+        { "merge_sort", [](std::vector<int> &array) { merge_sort(array); }, unlimited, unlimited },
+        { "merge_sort (sorting network)", [](std::vector<int> &array) {
+            merge_sort(array, base_case_method::sorting_network);
+        }, unlimited, unlimited },
+        { "bottom_up_merge_sort", [](std::vector<int> &array) { bottom_up_merge_sort(array); }, unlimited, unlimited },
+        { "tim_sort", [](std::vector<int> &array) { tim_sort(array); }, unlimited, unlimited },
+        { "heap_sort", [](std::vector<int> &array) { heap_sort(array); }, unlimited, unlimited },
+        { "quick_sort", [](std::vector<int> &array) { quick_sort(array); }, quadratic_limit, unlimited },
+        { "quick_sort (block)", [](std::vector<int> &array) {
+            quick_sort(array, partition_method::block);
+        }, quadratic_limit, unlimited },
+        { "quick_sort (block, sorting network)", [](std::vector<int> &array) {
+            quick_sort(array, partition_method::block, base_case_method::sorting_network);
+        }, quadratic_limit, unlimited },
+        // NB: only quadratic on few_unique, but that's enough to need limiting:
+        { "randomised_quick_sort", [](std::vector<int> &array) { randomised_quick_sort(array); }, quadratic_limit, unlimited },
+        { "randomised_quick_sort (block)", [](std::vector<int> &array) {
+            randomised_quick_sort(array, partition_method::block);
+        }, quadratic_limit, unlimited },
+        { "intro_sort", [](std::vector<int> &array) { intro_sort(array); }, unlimited, unlimited },
+        { "radix_sort", [](std::vector<int> &array) { radix_sort(array); }, unlimited, unlimited },
+        { "radix_sort (11-bit digits)", [](std::vector<int> &array) { radix_sort<11>(array); }, unlimited, unlimited },
+        { "parallel_merge_sort", [&pool](std::vector<int> &array) { parallel_merge_sort(array, pool); }, unlimited, unlimited },
+        { "parallel_sample_sort", [&pool](std::vector<int> &array) { parallel_sample_sort(array, pool); }, unlimited, unlimited },
+        { "std::sort", [](std::vector<int> &array) { std::sort(array.begin(), array.end()); }, unlimited, unlimited },
+        { "std::stable_sort", [](std::vector<int> &array) { std::stable_sort(array.begin(), array.end()); }, unlimited, unlimited }
+    };
+
+}
+
+std::vector<input_distribution> get_distributions() {
+
+    return {
+        { "random", [](std::vector<int> &array, xoshiro256_star_star &generator) {
+            fill_random(generator, array.begin(), array.end());
+        } },
+        { "sorted", [](std::vector<int> &array, xoshiro256_star_star&) {
+            for (int i = 0, l = array.size(); i < l; i++) { array[i] = i; }
+        } },
+        { "reversed", [](std::vector<int> &array, xoshiro256_star_star&) {
+            for (int i = 0, l = array.size(); i < l; i++) { array[i] = l - i; }
+        } },
+        // ascending to the middle, then descending:
+        { "organ_pipe", [](std::vector<int> &array, xoshiro256_star_star&) {
+            for (int i = 0, l = array.size(); i < l; i++) { array[i] = std::min(i, l - 1 - i); }
+        } },
+        { "few_unique", [](std::vector<int> &array, xoshiro256_star_star &generator) {
+            for (int &value : array) { value = uniform_int(generator, 16); }
+        } },
+        // 16 ascending runs:
+        { "sawtooth", [](std::vector<int> &array, xoshiro256_star_star&) {
+            int tooth_length = std::max(1, static_cast<int>((array.size() + 15) / 16));
+            for (int i = 0, l = array.size(); i < l; i++) { array[i] = i % tooth_length; }
+        } },
+        // sorted, apart from 1% of the elements swapped with random others:
+        { "nearly_sorted", [](std::vector<int> &array, xoshiro256_star_star &generator) {
+            int size = array.size();
+            for (int i = 0; i < size; i++) { array[i] = i; }
+            for (int i = 0, l = std::max(1, size / 100); i < l; i++) {
+                std::swap(array[uniform_int(generator, size)], array[uniform_int(generator, size)]);
+            }
+        } }
+    };
+
+}
+
+// the value at the given percentile (0 - 100) of sorted_values, by linear interpolation:
+double percentile(const std::vector<double> &sorted_values, double percent) {
+
+    double position = (sorted_values.size() - 1) * percent / 100.0;
+    int below = std::floor(position);
+    int above = std::min<int>(below + 1, sorted_values.size() - 1);
+    return sorted_values[below] + (sorted_values[above] - sorted_values[below]) * (position - below);
+
+}
+
+double mean(const std::vector<double> &values) {
+
+    double total = 0;
+    for (double value : values) { total += value; }
+    return total / values.size();
+
+}
+
+// returns false if the sort doesn't actually sort:
+bool run_benchmark(const sort_algorithm &algorithm, const std::vector<int> &input,
+                    int warmup, int repetitions, benchmark_result &result) {
+
+    int size = input.size();
+    int batch_size = std::max(1, batch_elements / std::max(size, 1));
+
+    result.batch_size = batch_size;
+    result.times_ms.clear();
+
+    std::vector<std::vector<int>> batch(batch_size);
+    timer<std::chrono::microseconds> batch_timer;
+
+    for (int run = 0; run < warmup + repetitions; run++) {
+
+        for (std::vector<int> &array : batch) { array = input; }
+
+        batch_timer.reset();
+        for (std::vector<int> &array : batch) { algorithm.sort(array); }
+        double time_ms = batch_timer.get_ticks() / 1000.0 / batch_size;
+
+        for (const std::vector<int> &array : batch) {
+            if (static_cast<int>(array.size()) != size || !std::is_sorted(array.begin(), array.end())) {
+                return false;
+            }
+        }
+
+        if (run >= warmup) { result.times_ms.push_back(time_ms); }
+
+    }
+
+    std::sort(result.times_ms.begin(), result.times_ms.end());
+    return true;
+
+}
+
+std::vector<std::string> split(const std::string &list) {
+
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) { items.push_back(item); }
+    }
+    return items;
+
+}
+
+void write_table(std::ostream &output, const benchmark_result &result) {
+
+    const std::vector<double> &times = result.times_ms;
+
+    output << std::left << std::setw(38) << result.algorithm << std::setw(15) << result.distribution
+            << std::right << std::setw(11) << result.size << std::fixed << std::setprecision(4)
+            << std::setw(14) << percentile(times, 50) << " ms"
+            << std::setw(12) << percentile(times, 10) << std::setw(12) << percentile(times, 90)
+            << std::setprecision(2) << std::setw(10) << percentile(times, 50) * 1e6 / std::max(result.size, 1LL)
+            << " ns/element\n" << std::defaultfloat;
+
+}
+
+void write_csv(std::ostream &output, const benchmark_result &result) {
+
+    const std::vector<double> &times = result.times_ms;
+
+    output << "\"" << result.algorithm << "\"," << result.distribution << "," << result.size << ","
+            << times.size() << "," << result.batch_size << "," << times.front() << "," << percentile(times, 10) << ","
+            << percentile(times, 50) << "," << percentile(times, 90) << "," << times.back() << "," << mean(times) << ","
+            << percentile(times, 50) * 1e6 / std::max(result.size, 1LL) << "\n";
+
+}
+
+void write_json(std::ostream &output, const benchmark_result &result, bool first) {
+
+    const std::vector<double> &times = result.times_ms;
+
+    output << (first ? "" : ",\n") << "    { \"algorithm\": \"" << result.algorithm
+            << "\", \"distribution\": \"" << result.distribution << "\", \"size\": " << result.size
+            << ", \"repetitions\": " << times.size() << ", \"batch_size\": " << result.batch_size
+            << ", \"min_ms\": " << times.front() << ", \"p10_ms\": " << percentile(times, 10)
+            << ", \"median_ms\": " << percentile(times, 50) << ", \"p90_ms\": " << percentile(times, 90)
+            << ", \"max_ms\": " << times.back() << ", \"mean_ms\": " << mean(times)
+            << ", \"median_ns_per_element\": " << percentile(times, 50) * 1e6 / std::max(result.size, 1LL) << " }";
+
+}
+
+int main(int argc, char **argv) {
+
+    long long min_size = 16;
+    long long max_size = 1000000;
+    int repetitions = 5;
+    int warmup = 1;
+    std::string format = "table";
+    std::string output_path;
+    std::vector<std::string> algorithm_names;
+    std::vector<std::string> distribution_names;
+
+    for (int i = 1; i < argc; i++) {
+
+        std::string argument = argv[i];
+        std::size_t equals = argument.find('=');
+        std::string option = argument.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+
+        if (option == "--min-size") {
+            min_size = std::stoll(value);
+        } else if (option == "--max-size") {
+            max_size = std::stoll(value);
+        } else if (option == "--repetitions") {
+            repetitions = std::max(1, std::stoi(value));
+        } else if (option == "--warmup") {
+            warmup = std::max(0, std::stoi(value));
+        } else if (option == "--algorithms") {
+            algorithm_names = split(value);
+        } else if (option == "--distributions") {
+            distribution_names = split(value);
+        } else if (option == "--format" && (value == "table" || value == "csv" || value == "json")) {
+            format = value;
+        } else if (option == "--output") {
+            output_path = value;
+        } else {
+            std::cerr << "unknown option: " << argument << "\n";
+            return 1;
+        }
+
+    }
+
+    // 16, 128, 1024, then powers of 10:
+    std::vector<long long> sizes;
+    for (long long size : { 16LL, 128LL, 1024LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL }) {
+        if (size >= min_size && size <= max_size) { sizes.push_back(size); }
+    }
+
+    thread_pool pool;
+    std::vector<sort_algorithm> algorithms = get_algorithms(pool);
+    std::vector<input_distribution> distributions = get_distributions();
+
+    auto selected = [](const std::vector<std::string> &names, const std::string &name) {
+        return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+    };
+
+    std::ofstream output_file;
+    if (!output_path.empty()) {
+        output_file.open(output_path);
+        if (!output_file) {
+            std::cerr << "couldn't open " << output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream &output = output_path.empty() ? std::cout : output_file;
+
+    if (format == "csv") {
+        output << "algorithm,distribution,size,repetitions,batch_size,min_ms,p10_ms,median_ms,p90_ms,max_ms,mean_ms,median_ns_per_element\n";
+    } else if (format == "json") {
+        output << "{\n  \"threads\": " << pool.get_thread_count() + 1
+                << ",\n  \"sorting_network_width\": " << sorting_network_ops::width << ",\n  \"results\": [\n";
+    } else {
+        output << "(" << pool.get_thread_count() + 1 << " threads, sorting network width "
+                << sorting_network_ops::width << ", median/p10/p90 of " << repetitions << " repetitions)\n";
+    }
+
+    bool all_sorted = true;
+    bool first_result = true;
+
+    for (const input_distribution &distribution : distributions) {
+
+        if (!selected(distribution_names, distribution.name)) { continue; }
+
+        for (long long size : sizes) {
+
+            xoshiro256_star_star generator(size);
+            std::vector<int> input(size);
+            distribution.generate(input, generator);
+
+            for (const sort_algorithm &algorithm : algorithms) {
+
+                if (!selected(algorithm_names, algorithm.name)) { continue; }
+                if (size > algorithm.max_size || (distribution.name != "random" && size > algorithm.max_patterned_size)) {
+                    continue;
+                }
+
+                benchmark_result result = { algorithm.name, distribution.name, size, 1, {} };
+
+                if (!run_benchmark(algorithm, input, warmup, repetitions, result)) {
+                    std::cerr << algorithm.name << " FAILED to sort " << distribution.name << " (" << size << ")\n";
+                    all_sorted = false;
+                    continue;
+                }
+
+                if (format == "csv") {
+                    write_csv(output, result);
+                } else if (format == "json") {
+                    write_json(output, result, first_result);
+                } else {
+                    write_table(output, result);
+                }
+                output.flush();
+                first_result = false;
+
+            }
+
+        }
+
+    }
+
+    if (format == "json") {
+        output << "\n  ]\n}\n";
+    }
+
+    return all_sorted ? 0 : 1;
+
+}
@@ -3,11 +3,28 @@
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <functional>
+#include <cstring>
 
 #include "./sort/insertion-sort.h"
 #include "./sort/merge-sort.h"
 #include "./sort/heap-sort.h"
 #include "./sort/quick-sort.h"
+#include "./sort/intro-sort.h"
+#include "./sort/parallel-merge-sort.h"
+#include "./sort/parallel-sample-sort.h"
+#include "./sort/radix-sort.h"
+#include "./sort/sorting-network.h"
+#include "./sort/tim-sort.h"
+#include "./sort/selection.h"
+#include "./sort/external-sort.h"
+#include "./sort/multiway-merge.h"
+#include "./sort/argsort.h"
+#include "./sort/string-sort.h"
+#include "./sort/priority-queue.h"
 #include "./helpers/timer.h"
 
 void print_array(const std::vector<int> &array) {
@@ -60,6 +77,9 @@ int main() {
     std::vector<int> array(10000);
     for (int i = 0, l = array.size(); i < l; i++) { array[i] = 2 * i; }
 
+    // NB: the sorting networks are only vectorised if compiled with SIMD enabled (e.g. -march=native):
+    std::cout << "sorting network vector width: " << sorting_network_ops::width << "\n";
+
     
     // insertion sort
 
@@ -91,6 +111,190 @@ int main() {
     }
 
     
+    // merge sort using sorting networks for small ranges
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "merge sort (sorting network base case): ";
+
+    sort_timer.reset();
+    merge_sort(array, base_case_method::sorting_network);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    // (for anything other than ints in ascending order, the network base case falls
+    // back to insertion sort):
+    {
+
+        std::vector<int> descending = array;
+        std::shuffle(descending.begin(), descending.end(), gen);
+        quick_sort(descending.begin(), descending.end(), std::greater<>(), partition_method::block, network_base_case());
+
+        std::vector<double> doubles(array.begin(), array.end());
+        std::shuffle(doubles.begin(), doubles.end(), gen);
+        merge_sort(doubles.begin(), doubles.end(), std::less<>(), network_base_case());
+
+        if (!std::is_sorted(descending.begin(), descending.end(), std::greater<>())
+                || !std::is_sorted(doubles.begin(), doubles.end())) {
+            std::cout << "network base case with other comparators or types: FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // bottom-up merge sort (reusing a buffer between calls)
+
+    {
+
+        std::vector<int> buffer;
+
+        for (int i = 0; i < 2; i++) {
+
+            std::shuffle(array.begin(), array.end(), gen);
+            std::cout << "bottom-up merge sort" << (i == 0 ? "" : " (reused buffer)") << ": ";
+
+            sort_timer.reset();
+            bottom_up_merge_sort(array, buffer);
+
+            std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+            if (!is_ordered_evens(array)) {
+                std::cout << "FAILED!\n";
+                throw;
+            }
+
+        }
+
+    }
+
+    
+    // tim sort
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "tim sort: ";
+
+    sort_timer.reset();
+    tim_sort(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // tim sort on nearly sorted input (a few out of place elements at the end)
+
+    std::shuffle(array.end() - 10, array.end(), gen);
+    std::swap(array[0], array[array.size() - 1]);
+    std::cout << "tim sort (nearly sorted): ";
+
+    sort_timer.reset();
+    tim_sort(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // parallel merge sort
+
+    {
+
+        thread_pool pool;
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "parallel merge sort (" << pool.get_thread_count() + 1 << " threads): ";
+
+        sort_timer.reset();
+        // NB: using a small grain size, since array isn't big enough to be split up otherwise:
+        parallel_merge_sort(array, pool, 256);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // parallel sample sort, against (serial) quick sort, on an array big enough to
+    // be split up with the default grain size
+
+    {
+
+        thread_pool pool;
+
+        std::vector<int> large_array(1 << 22);
+        for (int i = 0, l = large_array.size(); i < l; i++) { large_array[i] = 2 * i; }
+
+        std::shuffle(large_array.begin(), large_array.end(), gen);
+        std::cout << "quick sort (block partition, " << large_array.size() << " elements): ";
+
+        sort_timer.reset();
+        quick_sort(large_array, partition_method::block);
+
+        double quick_sort_ms = sort_timer.get_ticks() / 1000.0;
+        std::cout << quick_sort_ms << " ms (" << large_array.size() / (quick_sort_ms * 1000.0) << " M elements/s)\n";
+        if (!is_ordered_evens(large_array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        std::shuffle(large_array.begin(), large_array.end(), gen);
+        std::cout << "parallel sample sort (" << pool.get_thread_count() + 1 << " threads, " << large_array.size() << " elements): ";
+
+        sort_timer.reset();
+        parallel_sample_sort(large_array, pool);
+
+        double sample_sort_ms = sort_timer.get_ticks() / 1000.0;
+        std::cout << sample_sort_ms << " ms (" << large_array.size() / (sample_sort_ms * 1000.0) << " M elements/s)\n";
+        if (!is_ordered_evens(large_array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        // and with duplicates (so that some of the splitters are equal):
+        for (int i = 0, l = large_array.size(); i < l; i++) { large_array[i] = i % 8; }
+        std::shuffle(large_array.begin(), large_array.end(), gen);
+        std::cout << "parallel sample sort (few unique): ";
+
+        sort_timer.reset();
+        parallel_sample_sort(large_array, pool);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_sorted(large_array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        // both sorts can be called from tasks running on the same pool (whose workers
+        // run other tasks rather than blocking whilst they wait):
+        std::vector<int> second_array = large_array;
+        std::shuffle(large_array.begin(), large_array.end(), gen);
+        std::shuffle(second_array.begin(), second_array.end(), gen);
+        std::cout << "parallel sorts from tasks: ";
+
+        task_future<void> sample_sorted = pool.submit([&large_array, &pool]() { parallel_sample_sort(large_array, pool); });
+        task_future<void> merge_sorted = pool.submit([&second_array, &pool]() { parallel_merge_sort(second_array, pool); });
+        sample_sorted.get();
+        merge_sorted.get();
+
+        std::cout << "done\n";
+        if (!is_sorted(large_array) || !is_sorted(second_array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
     // heap sort
 
     std::shuffle(array.begin(), array.end(), gen);
@@ -136,6 +340,558 @@ int main() {
     }
 
     
+    // quick sort with block partitioning
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "quick sort (block partition): ";
+
+    sort_timer.reset();
+    quick_sort(array, partition_method::block);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // randomised quick sort with block partitioning
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "randomised quick sort (block partition): ";
+
+    sort_timer.reset();
+    randomised_quick_sort(array, partition_method::block);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // quick sort with block partitioning, using sorting networks for small ranges
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "quick sort (block partition, sorting network base case): ";
+
+    sort_timer.reset();
+    quick_sort(array, partition_method::block, base_case_method::sorting_network);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // intro sort
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "intro sort: ";
+
+    sort_timer.reset();
+    intro_sort(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // intro sort on already sorted input
+
+    std::cout << "intro sort (sorted): ";
+
+    sort_timer.reset();
+    intro_sort(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // intro sort on input with only a few distinct values
+
+    {
+
+        std::vector<int> few_unique(array.size());
+        for (int i = 0, l = few_unique.size(); i < l; i++) { few_unique[i] = i % 4; }
+        std::shuffle(few_unique.begin(), few_unique.end(), gen);
+        std::cout << "intro sort (few unique): ";
+
+        sort_timer.reset();
+        intro_sort(few_unique);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_sorted(few_unique)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // radix sort
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "radix sort: ";
+
+    sort_timer.reset();
+    radix_sort(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // radix sort with 11-bit digits
+
+    std::shuffle(array.begin(), array.end(), gen);
+    std::cout << "radix sort (11-bit digits): ";
+
+    sort_timer.reset();
+    radix_sort<11>(array);
+
+    std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+    if (!is_ordered_evens(array)) {
+        std::cout << "FAILED!\n";
+        throw;
+    }
+
+    
+    // radix sort on negative values, and on records by key
+
+    {
+
+        std::vector<int> signed_array(array.size());
+        for (int i = 0, l = signed_array.size(); i < l; i++) { signed_array[i] = array[i] - l; }
+        std::shuffle(signed_array.begin(), signed_array.end(), gen);
+
+        radix_sort(signed_array);
+        if (!is_sorted(signed_array)) {
+            std::cout << "radix sort (signed): FAILED!\n";
+            throw;
+        }
+
+        struct record { long long key; int index; };
+        std::vector<record> records(array.size());
+        for (int i = 0, l = records.size(); i < l; i++) { records[i] = { array[i] % 7 - 3, i }; }
+
+        radix_sort(records, [](const record &value) { return value.key; });
+        for (int i = 1, l = records.size(); i < l; i++) {
+            // should be sorted by key, and stable:
+            if (records[i - 1].key > records[i].key
+                    || (records[i - 1].key == records[i].key && records[i - 1].index > records[i].index)) {
+                std::cout << "radix sort (records): FAILED!\n";
+                throw;
+            }
+        }
+
+    }
+
+    
+    // multiway merge
+
+    {
+
+        // deal array out into (sorted) inputs of differing lengths:
+        std::vector<std::vector<int>> inputs(7);
+        for (int i = 0, l = array.size(); i < l; i++) { inputs[(i * i) % 7].push_back(2 * i); }
+
+        std::vector<int> merged;
+        std::cout << "multiway merge: ";
+
+        sort_timer.reset();
+        multiway_merge(inputs, merged);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(merged) || merged.size() != array.size()) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        thread_pool pool;
+        std::cout << "parallel multiway merge: ";
+
+        sort_timer.reset();
+        parallel_multiway_merge(inputs, merged, pool);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(merged) || merged.size() != array.size()) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // external sort
+
+    {
+
+        std::shuffle(array.begin(), array.end(), gen);
+
+        std::FILE *input_file = std::fopen("external-sort-input.bin", "wb");
+        std::fwrite(array.data(), sizeof(int), array.size(), input_file);
+        std::fclose(input_file);
+
+        std::cout << "external sort: ";
+
+        sort_timer.reset();
+        // NB: using a tiny memory budget so that there are plenty of runs, and more than one merge pass:
+        bool ok = external_sort<int>("external-sort-input.bin", "external-sort-output.bin", 4096);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+
+        std::FILE *output_file = std::fopen("external-sort-output.bin", "rb");
+        ok = ok && output_file && std::fread(array.data(), sizeof(int), array.size(), output_file) == array.size();
+        if (output_file) { std::fclose(output_file); }
+
+        std::remove("external-sort-input.bin");
+        std::remove("external-sort-output.bin");
+
+        // an input that ends in part of a record is an error, rather than being truncated:
+        input_file = std::fopen("external-sort-input.bin", "wb");
+        std::fwrite(array.data(), 1, 10 * sizeof(int) + 2, input_file);
+        std::fclose(input_file);
+        bool partial_failed = !external_sort<int>("external-sort-input.bin", "external-sort-output.bin", 4096);
+        std::remove("external-sort-input.bin");
+        std::remove("external-sort-output.bin");
+
+        if (!ok || !is_ordered_evens(array) || !partial_failed) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // selection
+
+    {
+
+        int k = array.size() / 3;
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "quick select: ";
+
+        sort_timer.reset();
+        int kth = quick_select(array, k);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (kth != 2 * k) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "smallest k: ";
+
+        sort_timer.reset();
+        std::vector<int> smallest = smallest_k(array, 100);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(smallest)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        std::cout << "partial heap sort: ";
+
+        sort_timer.reset();
+        partial_heap_sort(array, k);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(std::vector<int>(array.begin(), array.begin() + k))) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // the generic sorts, on move-only values, with a comparator (sorting into
+    // descending order of the values pointed to):
+
+    {
+
+        using sort_function = std::function<void(std::vector<std::unique_ptr<int>>::iterator,
+                                                    std::vector<std::unique_ptr<int>>::iterator)>;
+
+        auto descending = [](const std::unique_ptr<int> &a, const std::unique_ptr<int> &b) { return *a > *b; };
+
+        std::vector<std::pair<std::string, sort_function>> generic_sorts = {
+            { "insertion sort", [&descending](auto first, auto last) { insertion_sort(first, last, descending); } },
+            { "merge sort", [&descending](auto first, auto last) { merge_sort(first, last, descending); } },
+            { "heap sort", [&descending](auto first, auto last) { heap_sort(first, last, descending); } },
+            { "quick sort", [&descending](auto first, auto last) { quick_sort(first, last, descending); } },
+            { "quick sort (block partition)", [&descending](auto first, auto last) {
+                quick_sort(first, last, descending, partition_method::block);
+            } },
+            { "randomised quick sort", [&descending](auto first, auto last) { randomised_quick_sort(first, last, descending); } }
+        };
+
+        for (auto &generic_sort : generic_sorts) {
+
+            std::shuffle(array.begin(), array.end(), gen);
+            std::vector<std::unique_ptr<int>> pointers;
+            for (int value : array) { pointers.push_back(std::make_unique<int>(value)); }
+
+            std::cout << "generic " << generic_sort.first << " (move-only, descending): ";
+
+            sort_timer.reset();
+            generic_sort.second(pointers.begin(), pointers.end());
+
+            std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+            for (int i = 0, l = pointers.size(); i < l; i++) {
+                if (*pointers[i] != 2 * (l - 1 - i)) {
+                    std::cout << "FAILED!\n";
+                    throw;
+                }
+            }
+
+        }
+
+        // merge sort is stable, so sorting (key, position) pairs by key alone should
+        // leave the positions of equal keys in order:
+        std::vector<std::pair<int, int>> records;
+        for (int i = 0, l = array.size(); i < l; i++) { records.emplace_back(array[i] % 100, i); }
+
+        std::cout << "generic merge sort (stable, by key): ";
+
+        sort_timer.reset();
+        merge_sort(records.begin(), records.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+            return a.first < b.first;
+        });
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!std::is_sorted(records.begin(), records.end())) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // priority queues
+
+    {
+
+        // sorting by pushing everything and then popping it all (as a max-heap):
+        auto push_pop_sort = [&array](auto &queue) {
+            for (int value : array) { queue.push(value); }
+            for (int i = array.size() - 1; i >= 0; i--) { array[i] = queue.pop(); }
+        };
+
+        priority_queue<int, 2> binary_queue;
+        priority_queue<int, 4> four_ary_queue;
+        priority_queue<int, 8> eight_ary_queue;
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "priority queue (2-ary): ";
+        sort_timer.reset();
+        push_pop_sort(binary_queue);
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "priority queue (4-ary): ";
+        sort_timer.reset();
+        push_pop_sort(four_ary_queue);
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "priority queue (8-ary): ";
+        sort_timer.reset();
+        push_pop_sort(eight_ary_queue);
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        if (!is_ordered_evens(array)) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        // as a min-heap of timers, built in one go, with some of them brought forward
+        // (decrease-key) and some of them cancelled:
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "priority queue (timers): ";
+        sort_timer.reset();
+
+        priority_queue<int, 4, std::greater<>> timers(array);
+
+        // the timers with odd handles are brought forward to -1 - handle, and those
+        // with handles divisible by 4 are cancelled:
+        for (int i = 1, l = array.size(); i < l; i += 2) { timers.update(i, -1 - i); }
+        for (int i = 0, l = array.size(); i < l; i += 4) { timers.remove(i); }
+
+        std::vector<int> expired;
+        while (!timers.empty()) { expired.push_back(timers.pop()); }
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+
+        std::vector<int> expected;
+        for (int i = 0, l = array.size(); i < l; i++) {
+            if (i % 2 == 1) {
+                expected.push_back(-1 - i);
+            } else if (i % 4 != 0) {
+                expected.push_back(array[i]);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        if (expired != expected) {
+            std::cout << "FAILED!\n";
+            throw;
+        }
+
+        // building from no values, or just one:
+        priority_queue<int> empty_queue(std::vector<int> {});
+        priority_queue<int> single_queue(std::vector<int> { 42 });
+        if (!empty_queue.empty() || single_queue.size() != 1 || single_queue.top() != 42
+                || single_queue.pop() != 42 || !single_queue.empty()) {
+            std::cout << "priority queue (empty or single value): FAILED!\n";
+            throw;
+        }
+
+    }
+
+    
+    // argsort and sort_by_key
+
+    {
+
+        std::shuffle(array.begin(), array.end(), gen);
+        std::cout << "argsort: ";
+
+        sort_timer.reset();
+        std::vector<int> order = argsort(array);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        for (int i = 0, l = order.size(); i < l; i++) {
+            if (array[order[i]] != 2 * i) {
+                std::cout << "FAILED!\n";
+                throw;
+            }
+        }
+
+        // with a comparator (descending), and non-integer keys:
+        std::vector<double> double_keys(array.begin(), array.end());
+        std::cout << "argsort (descending doubles): ";
+
+        sort_timer.reset();
+        order = argsort(double_keys, std::greater<>());
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+        for (int i = 0, l = order.size(); i < l; i++) {
+            if (double_keys[order[i]] != 2 * (l - 1 - i)) {
+                std::cout << "FAILED!\n";
+                throw;
+            }
+        }
+
+        // values that know which key they started with:
+        std::vector<int> keys(array.size());
+        std::vector<std::string> values(array.size());
+        for (int i = 0, l = array.size(); i < l; i++) {
+            keys[i] = array[i] % 1000;
+            values[i] = std::to_string(keys[i]) + " from " + std::to_string(i);
+        }
+
+        std::cout << "sort by key: ";
+
+        sort_timer.reset();
+        sort_by_key(keys, values);
+
+        std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+
+        // keys should be sorted, each value should still be with it's key, and
+        // values with equal keys should still be in their original order:
+        int previous_position = -1;
+        for (int i = 0, l = keys.size(); i < l; i++) {
+
+            std::size_t separator = values[i].find(" from ");
+            int key = std::stoi(values[i].substr(0, separator));
+            int position = std::stoi(values[i].substr(separator + 6));
+
+            if (key != keys[i] || (i > 0 && keys[i] < keys[i - 1])
+                    || (i > 0 && keys[i] == keys[i - 1] && position < previous_position)) {
+                std::cout << "FAILED!\n";
+                throw;
+            }
+
+            previous_position = position;
+
+        }
+
+    }
+
+    
+    // string sorts (on strings with a long common prefix, and a few duplicates)
+
+    {
+
+        std::vector<std::string> string_storage(array.size());
+        std::uniform_int_distribution<int> length_distribution(0, 20);
+        std::uniform_int_distribution<int> character_distribution('a', 'z');
+        for (std::string &string : string_storage) {
+            string = "https://example.com/";
+            for (int i = 0, l = length_distribution(gen); i < l; i++) {
+                string += static_cast<char>(character_distribution(gen));
+            }
+        }
+
+        std::vector<const char*> strings;
+        for (const std::string &string : string_storage) { strings.push_back(string.c_str()); }
+
+        std::vector<const char*> sorted_strings = strings;
+        std::sort(sorted_strings.begin(), sorted_strings.end(), [](const char *a, const char *b) {
+            return std::strcmp(a, b) < 0;
+        });
+
+        std::vector<std::pair<std::string, std::function<void(std::vector<const char*>&)>>> string_sorts = {
+            { "multikey quick sort", [](std::vector<const char*> &strings) { multikey_quick_sort(strings); } },
+            { "multikey quick sort (cached keys)", [](std::vector<const char*> &strings) {
+                multikey_quick_sort(strings, string_key_cache::next_8_bytes);
+            } },
+            { "msd radix sort", [](std::vector<const char*> &strings) { msd_radix_sort(strings); } },
+            { "msd radix sort (cached keys)", [](std::vector<const char*> &strings) {
+                msd_radix_sort(strings, string_key_cache::next_8_bytes);
+            } }
+        };
+
+        for (auto &string_sort : string_sorts) {
+
+            std::shuffle(strings.begin(), strings.end(), gen);
+            std::cout << string_sort.first << ": ";
+
+            sort_timer.reset();
+            string_sort.second(strings);
+
+            std::cout << sort_timer.get_ticks() / 1000.0 << " ms\n";
+            for (int i = 0, l = strings.size(); i < l; i++) {
+                if (std::strcmp(strings[i], sorted_strings[i]) != 0) {
+                    std::cout << "FAILED!\n";
+                    throw;
+                }
+            }
+
+        }
+
+    }
+
+    
     // standard lib sort
 
     std::shuffle(array.begin(), array.end(), gen);
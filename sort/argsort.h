@@ -0,0 +1,103 @@
+
+// sorting with the keys kept separate from whatever they're attached to
+// (i.e. structure-of-arrays rather than an array of structures):
+// - argsort returns the permutation that sorts an array of keys, i.e. the indices
+//   of the keys in sorted order, without rearranging the keys themselves;
+// - apply_permutation rearranges an array according to such a permutation;
+// - sort_by_key sorts an array of keys and drags a parallel array of values along.
+// the sorting only ever touches compact (key, index) pairs, so the comparisons stay
+// in cache however big the values are, and each value is moved exactly once, at the
+// end. all of them are stable: equal keys keep their original order. integer keys
+// (with the default comparison) are sorted using radix_sort, and anything else
+// using merge_sort.
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+#include "./merge-sort.h"
+#include "./radix-sort.h"
+
+// returns the permutation that sorts keys such that compare(a, b) is true if a should
+// come before b, so keys[order[0]], keys[order[1]], ... are in sorted order:
+template <typename Key, typename Compare>
+std::vector<int> argsort(const std::vector<Key> &keys, Compare compare) {
+
+    int size = keys.size();
+
+    std::vector<std::pair<Key, int>> indexed_keys;
+    indexed_keys.reserve(size);
+    for (int i = 0; i < size; i++) { indexed_keys.emplace_back(keys[i], i); }
+
+    merge_sort(indexed_keys.begin(), indexed_keys.end(),
+                [&compare](const std::pair<Key, int> &a, const std::pair<Key, int> &b) {
+        return compare(a.first, b.first);
+    });
+
+    std::vector<int> order(size);
+    for (int i = 0; i < size; i++) { order[i] = indexed_keys[i].second; }
+
+    return order;
+
+}
+
+template <typename Key>
+std::vector<int> argsort(const std::vector<Key> &keys) {
+
+    if constexpr (std::is_integral<Key>::value) {
+
+        int size = keys.size();
+
+        std::vector<std::pair<Key, int>> indexed_keys;
+        indexed_keys.reserve(size);
+        for (int i = 0; i < size; i++) { indexed_keys.emplace_back(keys[i], i); }
+
+        radix_sort(indexed_keys, [](const std::pair<Key, int> &indexed_key) { return indexed_key.first; });
+
+        std::vector<int> order(size);
+        for (int i = 0; i < size; i++) { order[i] = indexed_keys[i].second; }
+
+        return order;
+
+    } else {
+        return argsort(keys, std::less<>());
+    }
+
+}
+
+// rearranges array such that the new array[i] is the old array[order[i]], where order
+// is a permutation of the indices of array (e.g. from argsort). each element is moved
+// once, into a new array, which then replaces array:
+template <typename T>
+void apply_permutation(const std::vector<int> &order, std::vector<T> &array) {
+
+    std::vector<T> permuted;
+    permuted.reserve(array.size());
+    for (int index : order) { permuted.push_back(std::move(array[index])); }
+
+    array.swap(permuted);
+
+}
+
+// sorts keys such that compare(a, b) is true if a should come before b, with values
+// (which must be the same size as keys) rearranged in the same way:
+template <typename Key, typename Value, typename Compare>
+void sort_by_key(std::vector<Key> &keys, std::vector<Value> &values, Compare compare) {
+
+    std::vector<int> order = argsort(keys, compare);
+    apply_permutation(order, keys);
+    apply_permutation(order, values);
+
+}
+
+template <typename Key, typename Value>
+void sort_by_key(std::vector<Key> &keys, std::vector<Value> &values) {
+
+    std::vector<int> order = argsort(keys);
+    apply_permutation(order, keys);
+    apply_permutation(order, values);
+
+}
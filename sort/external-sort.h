@@ -0,0 +1,310 @@
+
+// an external merge sort (ref: https://en.wikipedia.org/wiki/External_sorting), for
+// sorting binary files of fixed-width integer records (e.g. int32_t or uint64_t)
+// that are too big to sort in memory:
+// 1) the input is read memory_budget bytes at a time (well, half that, since
+//    radix_sort needs a buffer the same size as the data), each chunk is sorted
+//    with radix_sort, and written out to a temporary file as a sorted run;
+// 2) the runs are then merged, up to fan_in at a time, with the memory budget
+//    split between an input block for each run and an output block. if there are
+//    too many runs to merge at once (without the blocks getting too small for
+//    the reads and writes to stay large and sequential) then they're merged in
+//    several passes.
+// if the whole file fits within the budget then it's just sorted in memory and
+// written straight out.
+// like HashMap, errors (e.g. failing to open, read or write a file) are reported by
+// returning false, in which case any temporary files are removed. an input whose
+// size isn't a multiple of sizeof(T) (i.e. that ends in part of a record) counts as
+// an error too, rather than that last partial record just being dropped.
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+#include "./radix-sort.h"
+
+// the smallest block that each run gets when merging. fewer, larger blocks
+// means more merge passes, but keeps the I/O sequential:
+constexpr std::size_t external_sort_min_block_bytes = 1 << 16;
+
+// reads a file of T's sequentially, a block at a time:
+template <typename T>
+class external_sort_reader {
+
+public:
+
+    external_sort_reader(std::FILE *file, std::size_t block_size):
+        file(file), block(std::max<std::size_t>(block_size, 1)), position(0), count(0) {}
+
+    // returns false once the file is exhausted (or can't be read - see failed):
+    bool next(T &value) {
+
+        if (position == count) {
+            count = std::fread(block.data(), sizeof(T), block.size(), file);
+            position = 0;
+            if (count == 0) { return false; }
+        }
+
+        value = block[position++];
+        return true;
+
+    }
+
+    // whether a read has failed (so next returning false didn't mean the end of the file):
+    bool failed() const {
+        return std::ferror(file) != 0;
+    }
+
+private:
+
+    std::FILE *file;
+    std::vector<T> block;
+    std::size_t position;
+    std::size_t count;
+
+};
+
+// writes T's to a file sequentially, a block at a time:
+template <typename T>
+class external_sort_writer {
+
+public:
+
+    external_sort_writer(std::FILE *file, std::size_t block_size):
+        file(file), failed(false) {
+        block.reserve(std::max<std::size_t>(block_size, 1));
+    }
+
+    void write(T value) {
+
+        block.push_back(value);
+        if (block.size() == block.capacity()) { flush(); }
+
+    }
+
+    // returns false if any write has failed:
+    bool flush() {
+
+        if (!block.empty() && std::fwrite(block.data(), sizeof(T), block.size(), file) != block.size()) {
+            failed = true;
+        }
+        block.clear();
+        return !failed;
+
+    }
+
+private:
+
+    std::FILE *file;
+    std::vector<T> block;
+    bool failed;
+
+};
+
+// opens a file for unbuffered binary I/O (since we do our own, much larger, buffering):
+std::FILE* external_sort_open(const std::string &path, const char *mode) {
+
+    std::FILE *file = std::fopen(path.c_str(), mode);
+    if (file) {
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    return file;
+
+}
+
+// k-way merges the sorted runs in run_paths into the file at output_path:
+template <typename T>
+bool external_sort_merge(const std::vector<std::string> &run_paths, const std::string &output_path, std::size_t memory_budget) {
+
+    // split the budget between a block for each run and one for the output:
+    std::size_t block_size = memory_budget / ((run_paths.size() + 1) * sizeof(T));
+
+    std::vector<std::FILE*> run_files;
+    std::vector<external_sort_reader<T>> readers;
+    bool ok = true;
+
+    for (const std::string &path : run_paths) {
+        std::FILE *file = external_sort_open(path, "rb");
+        if (!file) { ok = false; break; }
+        run_files.push_back(file);
+        readers.emplace_back(file, block_size);
+    }
+
+    std::FILE *output_file = ok ? external_sort_open(output_path, "wb") : nullptr;
+
+    if (output_file) {
+
+        external_sort_writer<T> writer(output_file, block_size);
+
+        // a min-heap of the next value from each run (along with which run it's from):
+        std::priority_queue<std::pair<T, int>, std::vector<std::pair<T, int>>, std::greater<std::pair<T, int>>> next_values;
+
+        for (int i = 0, l = readers.size(); i < l; i++) {
+            T value;
+            if (readers[i].next(value)) { next_values.emplace(value, i); }
+        }
+
+        while (!next_values.empty()) {
+
+            std::pair<T, int> smallest = next_values.top();
+            next_values.pop();
+            writer.write(smallest.first);
+
+            T value;
+            if (readers[smallest.second].next(value)) { next_values.emplace(value, smallest.second); }
+
+        }
+
+        ok = writer.flush();
+        ok = (std::fclose(output_file) == 0) && ok;
+
+        // NB: a run that failed to read looks the same as one that ended, so without
+        // this the output would just be missing the rest of it:
+        for (const external_sort_reader<T> &reader : readers) {
+            ok = ok && !reader.failed();
+        }
+
+    } else {
+        ok = false;
+    }
+
+    for (std::FILE *file : run_files) {
+        std::fclose(file);
+    }
+
+    return ok;
+
+}
+
+// sorts the T's in the file at input_path into the file at output_path, using
+// roughly memory_budget bytes of memory, and writing temporary files into temp_directory:
+template <typename T>
+bool external_sort(const std::string &input_path, const std::string &output_path,
+                    std::size_t memory_budget, const std::string &temp_directory = ".") {
+
+    static_assert(std::is_integral<T>::value, "external_sort records must be integers");
+
+    std::vector<std::string> run_paths;
+    int next_temp_file = 0;
+
+    auto make_temp_path = [&temp_directory, &next_temp_file, &output_path]() {
+        // NB: including a hash of the output path, so that concurrent sorts into the
+        // same temp_directory don't collide:
+        return temp_directory + "/external-sort-" + std::to_string(std::hash<std::string>()(output_path))
+                + "-" + std::to_string(next_temp_file++) + ".tmp";
+    };
+
+    auto remove_runs = [](const std::vector<std::string> &paths) {
+        for (const std::string &path : paths) {
+            std::remove(path.c_str());
+        }
+    };
+
+    // 1) create the sorted runs:
+    {
+
+        std::FILE *input_file = external_sort_open(input_path, "rb");
+        if (!input_file) { return false; }
+
+        std::size_t run_capacity = std::max<std::size_t>(memory_budget / (2 * sizeof(T)), 1);
+        std::vector<T> run(run_capacity);
+        std::vector<T> buffer;
+
+        while (true) {
+
+            // (reading bytes rather than T's, so that a trailing partial record shows up):
+            run.resize(run_capacity);
+            std::size_t bytes = std::fread(run.data(), 1, run_capacity * sizeof(T), input_file);
+            if (bytes % sizeof(T) != 0) {
+                std::fclose(input_file);
+                remove_runs(run_paths);
+                return false;
+            }
+
+            std::size_t count = bytes / sizeof(T);
+            if (count == 0) { break; }
+            run.resize(count);
+
+            radix_sort(run, [](T value) { return value; }, buffer);
+
+            // if this is the whole of the input, then write it straight to the output:
+            bool is_whole_input = run_paths.empty() && count < run_capacity;
+            std::string path = is_whole_input ? output_path : make_temp_path();
+
+            std::FILE *run_file = external_sort_open(path, "wb");
+            bool ok = run_file && std::fwrite(run.data(), sizeof(T), count, run_file) == count;
+            ok = run_file && (std::fclose(run_file) == 0) && ok;
+
+            if (is_whole_input) {
+                std::fclose(input_file);
+                return ok;
+            }
+
+            run_paths.push_back(path);
+
+            if (!ok) {
+                std::fclose(input_file);
+                remove_runs(run_paths);
+                return false;
+            }
+
+        }
+
+        bool read_failed = std::ferror(input_file);
+        std::fclose(input_file);
+
+        if (read_failed) {
+            remove_runs(run_paths);
+            return false;
+        }
+
+    }
+
+    // an empty input gives an empty output:
+    if (run_paths.empty()) {
+        std::FILE *output_file = external_sort_open(output_path, "wb");
+        return output_file && std::fclose(output_file) == 0;
+    }
+
+    // 2) merge the runs, fan_in at a time, until they fit into one final merge:
+    std::size_t fan_in = std::max<std::size_t>(memory_budget / external_sort_min_block_bytes, 3) - 1;
+
+    while (run_paths.size() > fan_in) {
+
+        std::vector<std::string> merged_paths;
+
+        for (std::size_t i = 0; i < run_paths.size(); i += fan_in) {
+
+            std::vector<std::string> group(run_paths.begin() + i, run_paths.begin() + std::min(i + fan_in, run_paths.size()));
+            std::string merged_path = make_temp_path();
+            merged_paths.push_back(merged_path);
+
+            bool ok = external_sort_merge<T>(group, merged_path, memory_budget);
+            remove_runs(group);
+
+            if (!ok) {
+                remove_runs(std::vector<std::string>(run_paths.begin() + i + group.size(), run_paths.end()));
+                remove_runs(merged_paths);
+                return false;
+            }
+
+        }
+
+        run_paths = merged_paths;
+
+    }
+
+    bool ok = external_sort_merge<T>(run_paths, output_path, memory_budget);
+    remove_runs(run_paths);
+
+    return ok;
+
+}
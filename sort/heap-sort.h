@@ -1,69 +1,110 @@
 
+#pragma once
+
 #include <vector>
+#include <functional>
+#include <utility>
 
-// takes a heap, and an index into that heap. Assumes that 
-// the children of array[index] are both max-heaps in order 
-// to make the sub-tree rooted at array[index] a max-heap:
-void fix_max_heap_subtree(std::vector<int> &array, int index, int heap_length) {
+// takes a heap stored in [first, last), and a position root within that heap.
+// Assumes that the children of root are both max-heaps (with respect to compare)
+// in order to make the sub-tree rooted at root a max-heap. rather than swapping
+// root's value down the tree, it's moved out, and the larger children are moved up
+// into the hole until the value can be moved back in:
+template <typename RandomIt, typename Compare = std::less<>>
+void fix_max_heap_subtree(RandomIt first, RandomIt last, RandomIt root, Compare compare = Compare()) {
+
+    auto heap_length = last - first;
+    auto index = root - first;
+    auto value = std::move(*root);
 
     while (true) {
 
-        int left_child = 2 * index + 1;
-        int right_child = left_child + 1;
-        int largest = index;
+        auto left_child = 2 * index + 1;
+        auto right_child = left_child + 1;
+        auto largest = left_child;
 
-        if (left_child < heap_length && array[left_child] > array[largest]) {
-            largest = left_child;
-        }
-        if (right_child < heap_length && array[right_child] > array[largest]) {
+        if (left_child >= heap_length) { break; }
+        if (right_child < heap_length && compare(first[left_child], first[right_child])) {
             largest = right_child;
         }
 
-        if (largest == index) { break; }
-
-        // swap array[index] and array[largest]
-        int temp = array[index];
-        array[index] = array[largest];
-        array[largest] = temp;
+        if (!compare(value, first[largest])) { break; }
 
+        first[index] = std::move(first[largest]);
         index = largest;
 
     }
 
-}
+    first[index] = std::move(value);
 
-// converts an array of ints into a max heap:
-void array_to_max_heap(std::vector<int> &array) {
+}
 
-    int heap_size = array.size();
+// converts [first, last) into a max heap:
+template <typename RandomIt, typename Compare = std::less<>>
+void array_to_max_heap(RandomIt first, RandomIt last, Compare compare = Compare()) {
 
-    for (int i = heap_size/2; i >= 0; i--) {
+    for (auto i = (last - first) / 2; i >= 0; i--) {
 
-        fix_max_heap_subtree(array, i, heap_size);
+        if (first + i == last) { continue; }
+        fix_max_heap_subtree(first, last, first + i, compare);
 
     }
 
 }
 
-void heap_sort(std::vector<int> &array) {
+template <typename RandomIt, typename Compare = std::less<>>
+void heap_sort(RandomIt first, RandomIt last, Compare compare = Compare()) {
 
-    array_to_max_heap(array);
+    array_to_max_heap(first, last, compare);
 
-    int heap_size = array.size();
+    while (last - first > 1) {
 
-    while (heap_size > 1) {
+        // move current largest element to end of the heap, and remove
+        // it from the heap:
+        --last;
+        std::iter_swap(first, last);
 
-        // move current largest element to end of array:
-        int temp = array[0];
-        array[0] = array[heap_size - 1];
-        array[heap_size - 1] = temp;
+        // fix the heap:
+        fix_max_heap_subtree(first, last, first, compare);
 
-        // remove this element from the heap:
-        heap_size--;
+    }
 
-        // fix the heap:
-        fix_max_heap_subtree(array, 0, heap_size);
+}
 
+// takes a heap stored in array[heap_start ... heap_start + heap_length - 1], and an
+// index into that heap (relative to heap_start). Assumes that the children of
+// array[heap_start + index] are both max-heaps in order to make the sub-tree rooted
+// at array[heap_start + index] a max-heap:
+void fix_max_heap_subtree(std::vector<int> &array, int heap_start, int index, int heap_length) {
+    fix_max_heap_subtree(array.begin() + heap_start, array.begin() + heap_start + heap_length, array.begin() + heap_start + index);
+}
+
+// takes a heap, and an index into that heap. Assumes that
+// the children of array[index] are both max-heaps in order
+// to make the sub-tree rooted at array[index] a max-heap:
+void fix_max_heap_subtree(std::vector<int> &array, int index, int heap_length) {
+    fix_max_heap_subtree(array, 0, index, heap_length);
+}
+
+// converts array[start ... end] into a max heap:
+void array_to_max_heap(std::vector<int> &array, int start, int end) {
+    array_to_max_heap(array.begin() + start, array.begin() + end + 1);
+}
+
+// converts an array of ints into a max heap:
+void array_to_max_heap(std::vector<int> &array) {
+    array_to_max_heap(array.begin(), array.end());
+}
+
+// sorts array[start ... end]:
+void heap_sort(std::vector<int> &array, int start, int end) {
+
+    if (start < end) {
+        heap_sort(array.begin() + start, array.begin() + end + 1);
     }
 
 }
+
+void heap_sort(std::vector<int> &array) {
+    heap_sort(array.begin(), array.end());
+}
@@ -1,22 +1,44 @@
 
+#pragma once
+
 #include <vector>
+#include <functional>
+#include <utility>
 
-void insertion_sort(std::vector<int> &array) {
+// sorts [first, last) such that compare(a, b) is true if a should come before b.
+// values are moved rather than copied, so this works for move-only types:
+template <typename RandomIt, typename Compare = std::less<>>
+void insertion_sort(RandomIt first, RandomIt last, Compare compare = Compare()) {
+
+    if (first == last) { return; }
 
-    for (int i = 1, l = array.size(); i < l; i++) {
+    for (RandomIt i = first + 1; i != last; ++i) {
 
-        int value = array[i];
-        int j = i - 1;
+        auto value = std::move(*i);
+        RandomIt j = i;
 
-        while (j >= 0 && array[j] > value) {
+        while (j != first && compare(value, *(j - 1))) {
 
-            array[j + 1] = array[j];
-            j--;
+            *j = std::move(*(j - 1));
+            --j;
 
         }
 
-        array[j + 1] = value;
+        *j = std::move(value);
 
     }
 
 }
+
+// sorts array[start ... end]:
+void insertion_sort(std::vector<int> &array, int start, int end) {
+
+    if (start < end) {
+        insertion_sort(array.begin() + start, array.begin() + end + 1);
+    }
+
+}
+
+void insertion_sort(std::vector<int> &array) {
+    insertion_sort(array.begin(), array.end());
+}
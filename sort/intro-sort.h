@@ -0,0 +1,195 @@
+
+// an introspective sort (ref: https://en.wikipedia.org/wiki/Introsort) with a couple
+// of the pattern-defeating tricks from pdqsort (ref: https://arxiv.org/abs/2106.05123).
+// basically, this is quick_sort (using block_partition) with:
+// - median-of-three (or, for larger ranges, ninther) pivots, so that sorted and
+//   reversed inputs get good partitions;
+// - a three_way_partition whenever it looks like there are duplicates of the pivot,
+//   so that arrays with only a few distinct values don't go quadratic;
+// - a fall back to heap_sort if the recursion gets too deep, so that the worst case
+//   is O(n log n);
+// - network_sort for small ranges, where it's quicker than recursing;
+// - an attempt at a bounded insertion_sort whenever the pivot samples were already
+//   in order (and a reversal of ranges that look descending), so that already sorted,
+//   nearly sorted, and reversed ranges take O(n).
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "./insertion-sort.h"
+#include "./heap-sort.h"
+#include "./quick-sort.h"
+#include "./sorting-network.h"
+
+// ranges of this size or smaller are just given to network_sort (which, without
+// SIMD, is an insertion_sort, so a smaller size is used):
+constexpr int intro_sort_small_range_threshold = sorting_network_ops::width > 1 ? sorting_network_max_size : 16;
+// ranges larger than this use a ninther rather than a median-of-three:
+constexpr int intro_sort_ninther_threshold = 128;
+// the number of elements partial_insertion_sort will move before giving up:
+constexpr int intro_sort_partial_insertion_limit = 8;
+
+// sorts array[a], array[b], array[c] so that array[a] <= array[b] <= array[c].
+// returns whether or not they were already in order:
+inline bool sort_three(std::vector<int> &array, int a, int b, int c) {
+
+    bool in_order = true;
+
+    if (array[b] < array[a]) { std::swap(array[a], array[b]); in_order = false; }
+    if (array[c] < array[b]) { std::swap(array[b], array[c]); in_order = false; }
+    if (array[b] < array[a]) { std::swap(array[a], array[b]); in_order = false; }
+
+    return in_order;
+
+}
+
+// picks a pivot for array[start ... end] and moves it to the middle of the range,
+// with the smallest and largest of the samples at array[start] and array[end].
+// returns whether or not the sampled elements were already in order:
+inline bool choose_pivot(std::vector<int> &array, int start, int end) {
+
+    int size = end - start + 1;
+    int middle = start + size / 2;
+    bool in_order;
+
+    if (size > intro_sort_ninther_threshold) {
+        // if the range looks like it's in descending order, reverse it so that
+        // it can be picked up by partial_insertion_sort:
+        if (array[start] > array[start + 1] && array[start + 1] > array[middle]
+                && array[middle] > array[end - 1] && array[end - 1] > array[end]) {
+            std::reverse(array.begin() + start, array.begin() + end + 1);
+        }
+        // Tukey's ninther - the median of the medians of three samples of three:
+        in_order = sort_three(array, start, middle, end);
+        in_order &= sort_three(array, start + 1, middle - 1, end - 1);
+        in_order &= sort_three(array, start + 2, middle + 1, end - 2);
+        in_order &= sort_three(array, middle - 1, middle, middle + 1);
+    } else {
+        in_order = sort_three(array, start, middle, end);
+    }
+
+    return in_order;
+
+}
+
+// insertion sorts array[start ... end], but gives up (returning false) once more
+// than intro_sort_partial_insertion_limit elements have been moved. the idea
+// being that it's cheap to try on a range that's probably already sorted:
+inline bool partial_insertion_sort(std::vector<int> &array, int start, int end) {
+
+    int moved = 0;
+
+    for (int i = start + 1; i <= end; i++) {
+
+        if (!(array[i] < array[i - 1])) { continue; }
+
+        int value = array[i];
+        int j = i - 1;
+
+        while (j >= start && array[j] > value) {
+
+            array[j + 1] = array[j];
+            j--;
+
+        }
+
+        array[j + 1] = value;
+
+        moved += i - j - 1;
+        if (moved > intro_sort_partial_insertion_limit) { return false; }
+
+    }
+
+    return true;
+
+}
+
+// depth_limit is how many more levels of partitioning we'll do before giving up
+// and using heap_sort. leftmost is whether array[start] is the leftmost element
+// of the whole array being sorted - if it isn't, then array[start - 1] is a
+// previous pivot and so is <= every element of array[start ... end]:
+void intro_sort(std::vector<int> &array, int start, int end, int depth_limit, bool leftmost) {
+
+    // recurse on the smaller side of each partition and loop on the larger, so
+    // that the stack depth is O(log n):
+    while (end - start + 1 > intro_sort_small_range_threshold) {
+
+        if (depth_limit == 0) {
+            heap_sort(array, start, end);
+            return;
+        }
+        depth_limit--;
+
+        int middle = start + (end - start + 1) / 2;
+        bool samples_in_order = choose_pivot(array, start, end);
+
+        if (samples_in_order && partial_insertion_sort(array, start, end)) {
+            return;
+        }
+
+        // if the pivot is equal to the previous pivot, then every element of
+        // array[start ... end] is >= partition_value, and any duplicates of it
+        // can be dealt with in one go. we also use three_way_partition if any
+        // of the samples next to the pivot are equal to it:
+        int partition_value = array[middle];
+        bool duplicates_likely = (!leftmost && !(array[start - 1] < partition_value))
+            || array[start] == partition_value || array[end] == partition_value
+            || (end - start + 1 > intro_sort_ninther_threshold
+                && (array[middle - 1] == partition_value || array[middle + 1] == partition_value));
+
+        // partition and three_way_partition expect the pivot at the end:
+        std::swap(array[middle], array[end]);
+
+        if (duplicates_likely) {
+
+            std::pair<int, int> equal_range = three_way_partition(array, start, end);
+
+            if (equal_range.first - start < end - equal_range.second) {
+                intro_sort(array, start, equal_range.first - 1, depth_limit, leftmost);
+                start = equal_range.second + 1;
+                leftmost = false;
+            } else {
+                intro_sort(array, equal_range.second + 1, end, depth_limit, false);
+                end = equal_range.first - 1;
+            }
+
+            continue;
+
+        }
+
+        int partition_index = block_partition(array, start, end);
+
+        if (partition_index - start < end - partition_index) {
+            intro_sort(array, start, partition_index - 1, depth_limit, leftmost);
+            start = partition_index + 1;
+            leftmost = false;
+        } else {
+            intro_sort(array, partition_index + 1, end, depth_limit, false);
+            end = partition_index - 1;
+        }
+
+    }
+
+    network_sort(array, start, end);
+
+}
+
+// sorts array[start ... end]:
+void intro_sort(std::vector<int> &array, int start, int end) {
+
+    // allow 2 * log2(n) levels of partitioning before falling back to heap_sort:
+    int depth_limit = 0;
+    for (int size = end - start + 1; size > 1; size >>= 1) {
+        depth_limit += 2;
+    }
+
+    intro_sort(array, start, end, depth_limit, true);
+
+}
+
+void intro_sort(std::vector<int> &array) {
+    intro_sort(array, 0, array.size() - 1);
+}
@@ -1,56 +1,168 @@
 
+#pragma once
+
 #include <vector>
+#include <iterator>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+#include "./insertion-sort.h"
+#include "./sorting-network.h"
+
+// merges the sorted ranges [first, middle) and [middle, last), such that compare(a, b)
+// is true if a should come before b. the left range is moved out into buffer (which
+// keeps it's capacity between merges, so there's only ever the one allocation) and
+// then merged back in with the right range. if the left range is used up first
+// then the rest of the right range is already in place:
+template <typename RandomIt, typename Compare>
+void buffered_merge(RandomIt first, RandomIt middle, RandomIt last, Compare compare,
+                        std::vector<typename std::iterator_traits<RandomIt>::value_type> &buffer) {
+
+    buffer.clear();
+    buffer.insert(buffer.end(), std::make_move_iterator(first), std::make_move_iterator(middle));
+
+    auto left = buffer.begin();
+    auto left_end = buffer.end();
+    RandomIt right = middle;
+    RandomIt output = first;
+
+    while (left != left_end && right != last) {
+
+        // take from the right only if it's strictly smaller, so that equal elements
+        // keep their order:
+        if (compare(*right, *left)) {
+            *output++ = std::move(*right++);
+        } else {
+            *output++ = std::move(*left++);
+        }
+
+    }
+
+    std::move(left, left_end, output);
+
+}
+
+template <typename RandomIt, typename Compare, typename BaseCase>
+void merge_sort(RandomIt first, RandomIt last, Compare compare, BaseCase base_case,
+                    std::vector<typename std::iterator_traits<RandomIt>::value_type> &buffer) {
+
+    if (base_case(first, last, compare)) { return; }
+
+    if (last - first > 1) {
+
+        RandomIt middle = first + (last - first + 1) / 2;
+
+        merge_sort(first, middle, compare, base_case, buffer);
+        merge_sort(middle, last, compare, base_case, buffer);
+        buffered_merge(first, middle, last, compare, buffer);
+
+    }
+
+}
+
+// sorts [first, last) such that compare(a, b) is true if a should come before b.
+// the sort is stable, and moves rather than copies, so it works for move-only types:
+template <typename RandomIt, typename Compare = std::less<>, typename BaseCase = recursive_base_case>
+void merge_sort(RandomIt first, RandomIt last, Compare compare = Compare(), BaseCase base_case = BaseCase()) {
+
+    std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer;
+    buffer.reserve((last - first + 1) / 2);
+    merge_sort(first, last, compare, base_case, buffer);
+
+}
 
 // merges array[start ... middle] with array[middle + 1 ... end]:
 void merge(std::vector<int> &array, int start, int middle, int end) {
 
-    int left_size = middle - start + 1;
-    int right_size = end - middle;
+    std::vector<int> buffer;
+    buffered_merge(array.begin() + start, array.begin() + middle + 1, array.begin() + end + 1, std::less<>(), buffer);
 
-    std::vector<int> left(left_size);
-    std::vector<int> right(right_size);
+}
 
-    for (int i = 0; i < left_size; i++) {
-        left[i] = array[start + i];
-    }
+void merge_sort(std::vector<int> &array, int start, int end, base_case_method method = base_case_method::recurse) {
+
+    if (start >= end) { return; }
 
-    for (int i = 0; i < right_size; i++) {
-        right[i] = array[middle + 1 + i];
+    if (method == base_case_method::sorting_network) {
+        merge_sort(array.begin() + start, array.begin() + end + 1, std::less<>(), network_base_case());
+    } else {
+        merge_sort(array.begin() + start, array.begin() + end + 1);
     }
 
-    int left_pointer = 0;
-    int right_pointer = 0;
+}
+
+void merge_sort(std::vector<int> &array, base_case_method method = base_case_method::recurse) {
+    merge_sort(array, 0, array.size() - 1, method);
+}
 
-    for (int i = start; i <= end; i++) {
+// merges source[left_start ... left_end] with source[right_start ... right_end]
+// into destination, starting at destination[destination_start]:
+void merge_into(const std::vector<int> &source, int left_start, int left_end,
+                    int right_start, int right_end, std::vector<int> &destination, int destination_start) {
 
-        // if we've gone beyond the bounds of the left array, or we're still within the bounds of the right, and 
-        // the right element is smaller than the left, then take from the right; otherwise, take from the left:
-        if (left_pointer >= left_size || (right_pointer < right_size && left[left_pointer] > right[right_pointer])) {
-            array[i] = right[right_pointer];
-            right_pointer++;
+    int i = destination_start;
+
+    while (left_start <= left_end && right_start <= right_end) {
+        if (source[right_start] < source[left_start]) {
+            destination[i++] = source[right_start++];
         } else {
-            array[i] = left[left_pointer];
-            left_pointer++;
+            destination[i++] = source[left_start++];
         }
-
     }
 
+    while (left_start <= left_end) { destination[i++] = source[left_start++]; }
+    while (right_start <= right_end) { destination[i++] = source[right_start++]; }
+
 }
 
-void merge_sort(std::vector<int> &array, int start, int end) {
+// runs of this size are sorted with network_sort before bottom_up_merge_sort
+// starts merging:
+constexpr int merge_sort_run_length = 32;
 
-    if (start < end) {
+// a merge sort that doesn't allocate on every merge. rather than recursing, it
+// sorts runs of merge_sort_run_length using network_sort, and then merges pairs of runs
+// (doubling the run length each pass), ping-ponging between array and buffer.
+// buffer is resized to the size of array, so passing in the same buffer on
+// repeated calls means no allocations at all once it's big enough.
+// NB: if the sorted values end up in buffer after the last pass, then array and
+// buffer swap contents rather than copying back:
+void bottom_up_merge_sort(std::vector<int> &array, std::vector<int> &buffer) {
 
-        int middle = (start + end) / 2;
+    int size = array.size();
+
+    for (int start = 0; start < size; start += merge_sort_run_length) {
+        network_sort(array, start, std::min(start + merge_sort_run_length, size) - 1);
+    }
 
-        merge_sort(array, start, middle);
-        merge_sort(array, middle + 1, end);
-        merge(array, start, middle, end);
+    if (size <= merge_sort_run_length) { return; }
+
+    buffer.resize(size);
+    std::vector<int> *source = &array;
+    std::vector<int> *destination = &buffer;
+
+    for (int run_length = merge_sort_run_length; run_length < size; run_length *= 2) {
+
+        for (int left_start = 0; left_start < size; left_start += 2 * run_length) {
+
+            int right_start = std::min(left_start + run_length, size);
+            int right_end = std::min(left_start + 2 * run_length, size) - 1;
+
+            merge_into(*source, left_start, right_start - 1, right_start, right_end, *destination, left_start);
+
+        }
+
+        std::swap(source, destination);
+
+    }
 
+    if (source != &array) {
+        array.swap(buffer);
     }
 
 }
 
-void merge_sort(std::vector<int> &array) {
-    merge_sort(array, 0, array.size() - 1);
+void bottom_up_merge_sort(std::vector<int> &array) {
+    std::vector<int> buffer;
+    bottom_up_merge_sort(array, buffer);
 }
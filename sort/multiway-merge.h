@@ -0,0 +1,181 @@
+
+// k-way merging of sorted arrays using a tournament tree of losers
+// (ref: https://en.wikipedia.org/wiki/K-way_merge_algorithm#Tournament_Tree).
+// each leaf of the tree is one of the inputs, and each internal node holds the
+// input that lost the comparison made there, with the overall winner (i.e. the
+// input with the smallest next value) kept separately. once the winner's value
+// has been output, only the path from it's leaf to the root needs replaying, and
+// since each node on the path already holds the loser from the last time, that's
+// exactly one comparison per level - so log2(k) comparisons per element.
+// the merge is stable: equal values are taken from earlier inputs first.
+// parallel_multiway_merge splits the output into one slice per thread by co-ranking
+// (i.e. finding how many elements of each input come before each split point), so
+// that each thread can then merge into it's own part of the output.
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <climits>
+
+#include "../multi-threaded/thread-pool.h"
+
+// a sorted input, as [begin, end) pointers:
+using merge_range = std::pair<const int*, const int*>;
+
+// the loser tree compares (value, range index) pairs packed into a single
+// unsigned integer - the value (offset so that it's unsigned) in the upper 33 bits,
+// and the range index in the lower 31 bits - so that ties go to the earlier range
+// with a single comparison. a range that's been used up gets a value of 2^32, which
+// is larger than any int:
+inline unsigned long long loser_tree_entry(const merge_range &range, int index) {
+
+    unsigned long long value = range.first == range.second
+        ? (1ULL << 32)
+        : static_cast<unsigned long long>(static_cast<long long>(*range.first) - INT_MIN);
+
+    return (value << 31) | static_cast<unsigned long long>(index);
+
+}
+
+// merges the sorted ranges into output (which must have room for all of them):
+void loser_tree_merge(std::vector<merge_range> ranges, int *output) {
+
+    int num_ranges = ranges.size();
+    if (num_ranges == 0) { return; }
+
+    long long total = 0;
+    for (const merge_range &range : ranges) { total += range.second - range.first; }
+
+    // the tree has a power of two number of leaves - any extras are just empty ranges:
+    int num_leaves = 1;
+    while (num_leaves < num_ranges) { num_leaves *= 2; }
+    ranges.resize(num_leaves, merge_range(nullptr, nullptr));
+
+    constexpr unsigned long long index_mask = (1ULL << 31) - 1;
+
+    // losers[node] for node in [1, num_leaves), where node's children are 2 * node and
+    // 2 * node + 1, and leaf i is node num_leaves + i. build it bottom up, using
+    // winners to keep track of the winner of each subtree:
+    std::vector<unsigned long long> losers(num_leaves);
+    std::vector<unsigned long long> winners(2 * num_leaves);
+    for (int i = 0; i < num_leaves; i++) { winners[num_leaves + i] = loser_tree_entry(ranges[i], i); }
+    for (int node = num_leaves - 1; node >= 1; node--) {
+        winners[node] = std::min(winners[2 * node], winners[2 * node + 1]);
+        losers[node] = std::max(winners[2 * node], winners[2 * node + 1]);
+    }
+    unsigned long long winner = winners[1];
+
+    for (long long i = 0; i < total; i++) {
+
+        int leaf = winner & index_mask;
+        output[i] = *ranges[leaf].first;
+        ranges[leaf].first++;
+        winner = loser_tree_entry(ranges[leaf], leaf);
+
+        // replay the path from the leaf up to the root:
+        for (int node = (num_leaves + leaf) / 2; node >= 1; node /= 2) {
+            if (losers[node] < winner) {
+                std::swap(losers[node], winner);
+            }
+        }
+
+    }
+
+}
+
+// merges the sorted vectors in inputs into output:
+void multiway_merge(const std::vector<std::vector<int>> &inputs, std::vector<int> &output) {
+
+    std::vector<merge_range> ranges;
+    std::size_t total = 0;
+    for (const std::vector<int> &input : inputs) {
+        ranges.emplace_back(input.data(), input.data() + input.size());
+        total += input.size();
+    }
+
+    output.resize(total);
+    loser_tree_merge(ranges, output.data());
+
+}
+
+// co-ranking: finds how many elements of each range come within the first
+// output_index elements of their (stable) merge, returning them in split_points:
+void multiway_split_points(const std::vector<merge_range> &ranges, long long output_index, std::vector<long long> &split_points) {
+
+    int num_ranges = ranges.size();
+    split_points.assign(num_ranges, 0);
+    if (output_index <= 0) { return; }
+
+    // how many elements of all of the ranges are <= value:
+    auto count_not_greater = [&ranges](long long value) {
+        long long count = 0;
+        for (const merge_range &range : ranges) {
+            count += std::upper_bound(range.first, range.second, value) - range.first;
+        }
+        return count;
+    };
+
+    // binary search for the smallest value such that at least output_index elements
+    // are <= value (i.e. the value of the element at output_index - 1 in the merge):
+    long long low = INT_MIN;
+    long long high = INT_MAX;
+    while (low < high) {
+        long long middle = low + (high - low) / 2;
+        if (count_not_greater(middle) >= output_index) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    // take everything less than that value, and then make up the difference from
+    // the elements equal to it, taking them from the earlier ranges first (for stability):
+    long long remaining = output_index;
+    for (int i = 0; i < num_ranges; i++) {
+        split_points[i] = std::lower_bound(ranges[i].first, ranges[i].second, low) - ranges[i].first;
+        remaining -= split_points[i];
+    }
+    for (int i = 0; i < num_ranges && remaining > 0; i++) {
+        long long equal = (std::upper_bound(ranges[i].first, ranges[i].second, low) - ranges[i].first) - split_points[i];
+        long long taken = std::min(equal, remaining);
+        split_points[i] += taken;
+        remaining -= taken;
+    }
+
+}
+
+// as multiway_merge, but with the output split between the pool's threads (and the
+// calling thread):
+void parallel_multiway_merge(const std::vector<std::vector<int>> &inputs, std::vector<int> &output, thread_pool &pool) {
+
+    std::vector<merge_range> ranges;
+    long long total = 0;
+    for (const std::vector<int> &input : inputs) {
+        ranges.emplace_back(input.data(), input.data() + input.size());
+        total += input.size();
+    }
+
+    output.resize(total);
+
+    int num_slices = pool.get_thread_count() + 1;
+
+    // split_points[s] is where slice s starts in each of the inputs:
+    std::vector<std::vector<long long>> split_points(num_slices + 1);
+    for (int slice = 0; slice <= num_slices; slice++) {
+        multiway_split_points(ranges, total * slice / num_slices, split_points[slice]);
+    }
+
+    run_tasks_and_wait(pool, num_slices, [&ranges, &split_points, &output, total, num_slices](int slice) {
+
+        std::vector<merge_range> slice_ranges;
+        for (int i = 0, l = ranges.size(); i < l; i++) {
+            slice_ranges.emplace_back(ranges[i].first + split_points[slice][i], ranges[i].first + split_points[slice + 1][i]);
+        }
+
+        loser_tree_merge(slice_ranges, output.data() + total * slice / num_slices);
+
+    });
+
+}
@@ -0,0 +1,134 @@
+
+// a merge sort that spreads its work over a thread_pool. it works bottom-up:
+// 1) the array is split into (a power of two number of) chunks, which are sorted
+//    concurrently using merge_sort (with sorting networks for small ranges);
+// 2) adjacent sorted runs are then merged pairwise, round by round, between the
+//    array and a buffer. each merge is itself split into pieces (by binary
+//    searching for the points at which the output can be split) so that every
+//    thread has work to do, even in the final rounds when there are only a couple
+//    of (large) merges.
+// each step waits for all of its tasks to complete before the next one starts.
+// the calling thread takes a share of the work, and then waits for the rest. if
+// it's one of the pool's workers (i.e. this is called from a task), it runs other
+// pending tasks whilst it waits rather than blocking, so that's fine too.
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "./merge-sort.h"
+#include "../multi-threaded/thread-pool.h"
+
+// arrays (and chunks) smaller than this aren't worth splitting up any further:
+constexpr int parallel_merge_sort_grain_size = 1 << 14;
+
+// given two sorted ranges - source[left_start ... left_end] and
+// source[right_start ... right_end] - this returns how many elements of the left
+// range come within the first output_index elements of their merge. (i.e. it tells
+// us where to split the inputs in order to start merging from output_index.)
+// NB: as in merge, elements of the left range come first when equal:
+int merge_split_point(const std::vector<int> &source, int left_start, int left_end,
+                        int right_start, int right_end, int output_index) {
+
+    int left_size = left_end - left_start + 1;
+    int right_size = right_end - right_start + 1;
+
+    // binary search for the smallest number of elements from the left range
+    // that doesn't leave some left element needing to come before an element
+    // already taken from the right range:
+    int low = std::max(0, output_index - right_size);
+    int high = std::min(output_index, left_size);
+
+    while (low < high) {
+
+        int from_left = (low + high) / 2;
+        int from_right = output_index - from_left;
+
+        if (source[right_start + from_right - 1] >= source[left_start + from_left]) {
+            low = from_left + 1;
+        } else {
+            high = from_left;
+        }
+
+    }
+
+    return low;
+
+}
+
+void parallel_merge_sort(std::vector<int> &array, thread_pool &pool, int grain_size = parallel_merge_sort_grain_size) {
+
+    int size = array.size();
+
+    // the pool's threads, plus the calling thread:
+    int num_threads = pool.get_thread_count() + 1;
+
+    // use a power of two number of chunks (so that they merge evenly), with at
+    // least one chunk per thread, but without making the chunks smaller than grain_size:
+    int num_chunks = 1;
+    while (num_chunks < num_threads && size / (2 * num_chunks) >= grain_size) {
+        num_chunks *= 2;
+    }
+
+    if (num_chunks == 1) {
+        merge_sort(array, base_case_method::sorting_network);
+        return;
+    }
+
+    // chunk k is array[chunk_start(k) ... chunk_start(k + 1) - 1]:
+    auto chunk_start = [size, num_chunks](int chunk) {
+        return static_cast<int>(static_cast<long long>(size) * chunk / num_chunks);
+    };
+
+    // 1) sort each chunk:
+    run_tasks_and_wait(pool, num_chunks, [&array, &chunk_start](int chunk) {
+        merge_sort(array, chunk_start(chunk), chunk_start(chunk + 1) - 1, base_case_method::sorting_network);
+    });
+
+    // 2) merge pairs of runs, doubling the run length (in chunks) each round:
+    std::vector<int> buffer(size);
+    std::vector<int> *source = &array;
+    std::vector<int> *destination = &buffer;
+
+    for (int run_length = 1; run_length < num_chunks; run_length *= 2) {
+
+        int num_merges = num_chunks / (2 * run_length);
+        // split each merge into enough pieces that there's (at least) one per thread:
+        int pieces_per_merge = std::max(1, num_threads / num_merges);
+
+        run_tasks_and_wait(pool, num_merges * pieces_per_merge,
+                            [source, destination, &chunk_start, run_length, pieces_per_merge](int task) {
+
+            int merge = task / pieces_per_merge;
+            int piece = task % pieces_per_merge;
+
+            int left_start = chunk_start(2 * merge * run_length);
+            int right_start = chunk_start((2 * merge + 1) * run_length);
+            int right_end = chunk_start((2 * merge + 2) * run_length) - 1;
+            int left_end = right_start - 1;
+
+            // this piece produces output[piece_start ... piece_end - 1] of the merge:
+            long long merge_size = right_end - left_start + 1;
+            int piece_start = merge_size * piece / pieces_per_merge;
+            int piece_end = merge_size * (piece + 1) / pieces_per_merge;
+
+            int left_from = merge_split_point(*source, left_start, left_end, right_start, right_end, piece_start);
+            int left_to = merge_split_point(*source, left_start, left_end, right_start, right_end, piece_end);
+
+            merge_into(*source, left_start + left_from, left_start + left_to - 1,
+                        right_start + (piece_start - left_from), right_start + (piece_end - left_to) - 1,
+                        *destination, left_start + piece_start);
+
+        });
+
+        std::swap(source, destination);
+
+    }
+
+    // the sorted values are in source, which may be the buffer:
+    if (source != &array) {
+        array.swap(buffer);
+    }
+
+}
@@ -0,0 +1,195 @@
+
+// a sample sort (ref: https://en.wikipedia.org/wiki/Samplesort) that spreads its
+// work over a thread_pool, including the partitioning, which is where
+// parallel_merge_sort spends it's last (and least parallel) rounds. following
+// super scalar sample sort (ref: https://doi.org/10.1007/978-3-540-30140-0_69):
+// 1) a random sample of the array is sorted, and evenly spaced elements of it are
+//    picked as splitters, which divide the values into (a power of two number of)
+//    buckets. the splitters are laid out as an implicit binary search tree, so
+//    that finding an element's bucket is log2(num_buckets) steps of
+//    node = 2 * node + (value > tree[node]), with nothing to mispredict;
+// 2) each thread classifies a slice of the array in one pass, remembering each
+//    element's bucket and counting the size of each bucket within it's slice;
+// 3) from those counts, every thread knows exactly where each of it's elements
+//    goes, so they all scatter their slices into a buffer concurrently, without
+//    any two threads writing to the same place;
+// 4) the buckets are then sorted concurrently with intro_sort (biggest first,
+//    with each thread taking the next bucket once it's done with the last).
+// each bucket also has an 'equality' bucket alongside it for elements equal to
+// it's upper splitter. since these don't need sorting at all, values that are
+// common enough to be picked as a splitter more than once don't end up as one
+// huge bucket that only a single thread can work on.
+// as with parallel_merge_sort, the calling thread takes a share of the work and
+// then waits for the rest (running other tasks in the meantime, if it's one of the
+// pool's workers), so this can be called from a task on the same pool.
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "./intro-sort.h"
+#include "../multi-threaded/thread-pool.h"
+#include "../helpers/random.h"
+
+// arrays smaller than this (and buckets, on average) aren't worth splitting up any further:
+constexpr int parallel_sample_sort_grain_size = 1 << 14;
+
+// (NB: at most 128, so that bucket indices, including the equality buckets, fit in an unsigned char):
+constexpr int parallel_sample_sort_max_buckets = 128;
+
+// how many samples are taken for each bucket. more samples mean more evenly
+// sized buckets, but a bigger sample to sort:
+constexpr int parallel_sample_sort_oversampling = 32;
+
+// lays out splitters[start ... end - 1] as the subtree of tree rooted at node,
+// where node's children are 2 * node and 2 * node + 1:
+void build_splitter_tree(const std::vector<int> &splitters, int start, int end, std::vector<int> &tree, int node) {
+
+    if (start >= end) { return; }
+
+    int middle = start + (end - start) / 2;
+    tree[node] = splitters[middle];
+    build_splitter_tree(splitters, start, middle, tree, 2 * node);
+    build_splitter_tree(splitters, middle + 1, end, tree, 2 * node + 1);
+
+}
+
+void parallel_sample_sort(std::vector<int> &array, thread_pool &pool, int grain_size = parallel_sample_sort_grain_size) {
+
+    int size = array.size();
+
+    // the pool's threads, plus the calling thread:
+    int num_threads = pool.get_thread_count() + 1;
+
+    // a few buckets per thread (so that uneven buckets still balance out), but
+    // without making the buckets smaller than grain_size on average:
+    int num_buckets = 1;
+    int log_buckets = 0;
+    while (num_buckets < 4 * num_threads && num_buckets < parallel_sample_sort_max_buckets
+            && size / (2 * num_buckets) >= grain_size) {
+        num_buckets *= 2;
+        log_buckets++;
+    }
+
+    if (num_buckets == 1) {
+        intro_sort(array);
+        return;
+    }
+
+    // 1) pick the splitters from a sorted random sample:
+    std::vector<int> splitters(num_buckets);
+    std::vector<int> tree(num_buckets);
+    {
+
+        xoshiro256_star_star &generator = default_generator();
+
+        std::vector<int> sample(num_buckets * parallel_sample_sort_oversampling);
+        for (int &value : sample) { value = array[uniform_int(generator, size)]; }
+        intro_sort(sample);
+
+        for (int i = 0; i < num_buckets - 1; i++) {
+            splitters[i] = sample[(i + 1) * parallel_sample_sort_oversampling - 1];
+        }
+        build_splitter_tree(splitters, 0, num_buckets - 1, tree, 1);
+
+        // the last bucket has no upper splitter, so give it one that nothing in it can
+        // be equal to (everything in it being greater than the previous splitter):
+        splitters[num_buckets - 1] = splitters[num_buckets - 2];
+
+    }
+
+    // bucket 2 * b holds values in (splitters[b - 1], splitters[b]), and
+    // bucket 2 * b + 1 holds values equal to splitters[b]:
+    int num_bucket_ids = 2 * num_buckets;
+
+    // thread t's slice is array[slice_start(t) ... slice_start(t + 1) - 1]:
+    auto slice_start = [size, num_threads](int thread) {
+        return static_cast<int>(static_cast<long long>(size) * thread / num_threads);
+    };
+
+    // 2) classify each slice, recording each element's bucket in bucket_ids, and the
+    // size of bucket b within thread t's slice in counts[t * num_bucket_ids + b]:
+    std::vector<unsigned char> bucket_ids(size);
+    std::vector<int> counts(num_threads * num_bucket_ids, 0);
+
+    run_tasks_and_wait(pool, num_threads, [&](int thread) {
+
+        const int *values = array.data();
+        const int *splitter_tree = tree.data();
+        const int *upper_splitters = splitters.data();
+        int *thread_counts = counts.data() + thread * num_bucket_ids;
+
+        for (int i = slice_start(thread), end = slice_start(thread + 1); i < end; i++) {
+
+            int value = values[i];
+            int node = 1;
+            for (int level = 0; level < log_buckets; level++) {
+                node = 2 * node + (value > splitter_tree[node]);
+            }
+
+            int bucket = node - num_buckets;
+            int bucket_id = 2 * bucket + (value == upper_splitters[bucket]);
+
+            bucket_ids[i] = bucket_id;
+            thread_counts[bucket_id]++;
+
+        }
+
+    });
+
+    // turn the counts into where each thread starts writing each bucket, with the
+    // buckets in order, and each bucket's part from each thread in thread order:
+    std::vector<int> bucket_starts(num_bucket_ids + 1);
+    {
+        int offset = 0;
+        for (int bucket_id = 0; bucket_id < num_bucket_ids; bucket_id++) {
+            bucket_starts[bucket_id] = offset;
+            for (int thread = 0; thread < num_threads; thread++) {
+                int count = counts[thread * num_bucket_ids + bucket_id];
+                counts[thread * num_bucket_ids + bucket_id] = offset;
+                offset += count;
+            }
+        }
+        bucket_starts[num_bucket_ids] = offset;
+    }
+
+    // 3) scatter each slice into the buckets:
+    std::vector<int> buffer(size);
+
+    run_tasks_and_wait(pool, num_threads, [&](int thread) {
+
+        int *offsets = counts.data() + thread * num_bucket_ids;
+
+        for (int i = slice_start(thread), end = slice_start(thread + 1); i < end; i++) {
+            buffer[offsets[bucket_ids[i]]++] = array[i];
+        }
+
+    });
+
+    array.swap(buffer);
+
+    // 4) sort the (non-equality) buckets, biggest first:
+    std::vector<int> buckets;
+    for (int bucket_id = 0; bucket_id < num_bucket_ids; bucket_id += 2) {
+        if (bucket_starts[bucket_id + 1] - bucket_starts[bucket_id] > 1) {
+            buckets.push_back(bucket_id);
+        }
+    }
+    std::sort(buckets.begin(), buckets.end(), [&bucket_starts](int a, int b) {
+        return bucket_starts[a + 1] - bucket_starts[a] > bucket_starts[b + 1] - bucket_starts[b];
+    });
+
+    std::atomic<int> next_bucket(0);
+    int num_buckets_to_sort = buckets.size();
+
+    run_tasks_and_wait(pool, std::max(1, std::min(num_threads, num_buckets_to_sort)), [&](int) {
+
+        for (int i = next_bucket++; i < num_buckets_to_sort; i = next_bucket++) {
+            intro_sort(array, bucket_starts[buckets[i]], bucket_starts[buckets[i] + 1] - 1);
+        }
+
+    });
+
+}
@@ -0,0 +1,236 @@
+
+// a priority queue (ref: https://en.wikipedia.org/wiki/D-ary_heap) stored as a d-ary
+// max-heap - the same layout as heap_sort's binary heap, but with arity children per
+// node (the children of heap[i] being heap[arity * i + 1 ... arity * i + arity]).
+// a wider heap is shallower, so pushing (which sifts up) touches fewer levels, and
+// whilst popping (which sifts down) compares more children per level, they're next
+// to each other in memory - with a 4-ary heap of ints, say, a node's children span
+// at most two cache lines (and usually just one), whereas a large binary heap
+// touches a new cache line on nearly every level.
+// like std::priority_queue, top() is the largest value according to compare, so
+// e.g. a queue of timers that should pop the earliest first would use std::greater<>.
+// push returns a handle to the value, which stays valid for as long as it's in the
+// queue (however it moves around the heap), and can be used to change it's value
+// (e.g. decrease-key) or remove it. once a value's been popped or removed, it's
+// handle may be reused by a later push - so NB: remove, update and get mustn't be
+// given the handle of a value that's no longer in the queue (see contains).
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+template <typename T, int arity = 4, typename Compare = std::less<>>
+class priority_queue {
+
+    static_assert(arity >= 2, "priority_queue arity must be at least 2");
+
+public:
+
+    using handle = int;
+
+    priority_queue(Compare compare = Compare()): compare(compare) {}
+
+    // builds the heap from values in one go (in O(n), rather than O(n log n) for
+    // pushing them one at a time). values[i] gets the handle i:
+    priority_queue(std::vector<T> values, Compare compare = Compare()): compare(compare) {
+
+        int size = values.size();
+
+        heap.reserve(size);
+        positions.resize(size);
+        for (int i = 0; i < size; i++) {
+            heap.push_back({ std::move(values[i]), i });
+            positions[i] = i;
+        }
+
+        // (NB: with fewer than 2 values there's nothing to sift, and (size - 2) / arity
+        // would round towards 0 rather than down):
+        if (size > 1) {
+            for (int i = (size - 2) / arity; i >= 0; i--) {
+                sift_down(i);
+            }
+        }
+
+    }
+
+    handle push(T value) {
+
+        handle new_handle;
+        if (free_handles.empty()) {
+            new_handle = positions.size();
+            positions.push_back(0);
+        } else {
+            new_handle = free_handles.back();
+            free_handles.pop_back();
+        }
+
+        heap.push_back({ std::move(value), new_handle });
+        positions[new_handle] = heap.size() - 1;
+        sift_up(heap.size() - 1);
+
+        return new_handle;
+
+    }
+
+    // NB: the queue mustn't be empty:
+    const T& top() const {
+        return heap[0].value;
+    }
+
+    handle top_handle() const {
+        return heap[0].value_handle;
+    }
+
+    // removes and returns the largest value. NB: the queue mustn't be empty:
+    T pop() {
+        return remove_at(0);
+    }
+
+    // removes (and returns) the value with the given handle:
+    T remove(handle value_handle) {
+        assert(contains(value_handle));
+        return remove_at(positions[value_handle]);
+    }
+
+    // whether the value with the given handle is (still) in the queue:
+    bool contains(handle value_handle) const {
+        return value_handle >= 0 && value_handle < static_cast<int>(positions.size()) && positions[value_handle] >= 0;
+    }
+
+    const T& get(handle value_handle) const {
+        assert(contains(value_handle));
+        return heap[positions[value_handle]].value;
+    }
+
+    // replaces the value with the given handle, moving it up or down the heap as
+    // needed. (so this is decrease-key, or increase-key, depending on compare):
+    void update(handle value_handle, T value) {
+
+        assert(contains(value_handle));
+        int index = positions[value_handle];
+        bool moves_up = compare(heap[index].value, value);
+        heap[index].value = std::move(value);
+
+        if (moves_up) {
+            sift_up(index);
+        } else {
+            sift_down(index);
+        }
+
+    }
+
+    int size() const {
+        return heap.size();
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    void clear() {
+        heap.clear();
+        positions.clear();
+        free_handles.clear();
+    }
+
+private:
+
+    struct entry {
+        T value;
+        handle value_handle;
+    };
+
+    Compare compare;
+    std::vector<entry> heap;
+    // the index in heap of each handle's value (or -1 if it's not in the queue):
+    std::vector<int> positions;
+    std::vector<handle> free_handles;
+
+    T remove_at(int index) {
+
+        entry removed = std::move(heap[index]);
+        positions[removed.value_handle] = -1;
+        free_handles.push_back(removed.value_handle);
+
+        // fill the hole with the last entry, which may need to go either way:
+        int last = heap.size() - 1;
+        if (index != last) {
+
+            bool moves_up = compare(removed.value, heap[last].value);
+            heap[index] = std::move(heap[last]);
+            heap.pop_back();
+            positions[heap[index].value_handle] = index;
+
+            if (moves_up) {
+                sift_up(index);
+            } else {
+                sift_down(index);
+            }
+
+        } else {
+            heap.pop_back();
+        }
+
+        return std::move(removed.value);
+
+    }
+
+    // as with fix_max_heap_subtree, the entry is moved out, and the entries it
+    // passes are moved into the hole, rather than swapping at every level:
+    void sift_up(int index) {
+
+        entry moving = std::move(heap[index]);
+
+        while (index > 0) {
+
+            int parent = (index - 1) / arity;
+            if (!compare(heap[parent].value, moving.value)) { break; }
+
+            heap[index] = std::move(heap[parent]);
+            positions[heap[index].value_handle] = index;
+            index = parent;
+
+        }
+
+        heap[index] = std::move(moving);
+        positions[heap[index].value_handle] = index;
+
+    }
+
+    void sift_down(int index) {
+
+        int size = heap.size();
+        entry moving = std::move(heap[index]);
+
+        while (true) {
+
+            int first_child = arity * index + 1;
+            if (first_child >= size) { break; }
+
+            // find the largest of the (up to arity) children:
+            int last_child = std::min(first_child + arity, size);
+            int largest = first_child;
+            for (int child = first_child + 1; child < last_child; child++) {
+                if (compare(heap[largest].value, heap[child].value)) {
+                    largest = child;
+                }
+            }
+
+            if (!compare(moving.value, heap[largest].value)) { break; }
+
+            heap[index] = std::move(heap[largest]);
+            positions[heap[index].value_handle] = index;
+            index = largest;
+
+        }
+
+        heap[index] = std::move(moving);
+        positions[heap[index].value_handle] = index;
+
+    }
+
+};
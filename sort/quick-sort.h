@@ -1,55 +1,242 @@
 
+#pragma once
+
 #include <vector>
-#include <random>
+#include <iterator>
 #include <functional>
+#include <utility>
+#include <algorithm>
+
+#include "./sorting-network.h"
+#include "../helpers/random.h"
+
+// partitions [first, last) and returns the point at which it's been split such
+// that every element to the left is less than the element at the partition, and
+// every element to the right is greater (or equal), where compare(a, b) is true if a
+// is less than b. the element at the partition is the one that was at last - 1:
+template <typename RandomIt, typename Compare = std::less<>>
+RandomIt lomuto_partition(RandomIt first, RandomIt last, Compare compare = Compare()) {
+
+    // the last element acts as the partition value (and stays put until the end):
+    RandomIt partition_value = last - 1;
+
+    // now swap any elements less than that value to the start
+    // (and thus, as a consequence, elements larger than partition_value
+    // will be at the end):
+    RandomIt partition_point = first;
+    for (RandomIt i = first; i != partition_value; ++i) {
+        if (compare(*i, *partition_value)) {
+            std::iter_swap(i, partition_point);
+            ++partition_point;
+        }
+    }
+
+    // partition_point now points to the point at which the partition
+    // will take place. Just need to swap the partition_value into place:
+    std::iter_swap(partition_value, partition_point);
+
+    return partition_point;
+
+}
 
 // partitions an array and returns the index of the point at which 
 // the array has been split such that every element to the left is 
 // less than the value at the partition, and every element to the right 
 // is greater
 int partition(std::vector<int> &array, int start, int end) {
+    return lomuto_partition(array.begin() + start, array.begin() + end + 1) - array.begin();
+}
 
-    // choose some value to act as the partition:
-    int partition_value = array[end];
+// like lomuto_partition, but splits [first, last) into three parts: elements
+// less than the partition value, elements equal to it, and elements greater
+// than it. returns the 'equal' part as [first, last) iterators. this means
+// runs of duplicates are dealt with in one go rather than being repeatedly
+// partitioned (which is what sends partition quadratic on arrays with only a
+// few distinct values):
+template <typename RandomIt, typename Compare = std::less<>>
+std::pair<RandomIt, RandomIt> three_way_partition(RandomIt first, RandomIt last, Compare compare = Compare()) {
 
-    // now swap any elements less than that value to the start
-    // (and thus, as a consequence, elements larger than partition_value
-    // will be at the end):
-    int partition_index = start;
-    for (int i = start; i < end; i++) {
-        if (array[i] < partition_value) {
-            int temp = array[i];
-            array[i] = array[partition_index];
-            array[partition_index] = temp;
-            partition_index++;
+    // the partition value (from last - 1) is moved to the front, so that it starts off
+    // as the 'equal' part - which means *less_end is always equal to it, and can be
+    // compared against without needing a copy of it.
+    // invariant: [first, less_end) < partition value, [less_end, i) == partition
+    // value, and [greater_start, last) > partition value:
+    std::iter_swap(first, last - 1);
+    RandomIt less_end = first;
+    RandomIt i = first + 1;
+    RandomIt greater_start = last;
+
+    while (i != greater_start) {
+
+        if (compare(*i, *less_end)) {
+            std::iter_swap(i, less_end);
+            ++less_end;
+            ++i;
+        } else if (compare(*less_end, *i)) {
+            --greater_start;
+            std::iter_swap(i, greater_start);
+        } else {
+            ++i;
         }
+
     }
 
-    // partition_index now points to the point in the array at which 
-    // the partition will take place. Just need to swap the partition_value
-    // into place:
-    array[end] = array[partition_index];
-    array[partition_index] = partition_value;
+    return std::make_pair(less_end, greater_start);
+
+}
+
+// returns the first and last indices of the 'equal' part of array[start ... end],
+// partitioned around array[end]:
+std::pair<int, int> three_way_partition(std::vector<int> &array, int start, int end) {
 
-    return partition_index;
+    auto equal_range = three_way_partition(array.begin() + start, array.begin() + end + 1);
+    return std::make_pair(equal_range.first - array.begin(), equal_range.second - array.begin() - 1);
 
 }
 
-void quick_sort(std::vector<int> &array, int start, int end) {
+// the number of elements block_partition compares at a time from each end
+// (NB: must be <= 256 so that offsets fit in an unsigned char):
+constexpr int partition_block_size = 128;
 
-    if (start < end) {
+// a two-ended partition, following BlockQuicksort (ref: https://arxiv.org/abs/1604.06697).
+// like Hoare's original partition scheme, it scans inwards from both ends, swapping
+// elements that are >= the partition value on the left with ones that are < it on
+// the right. but rather than branching on each comparison (which on random data
+// will be mispredicted about half of the time), it scans a block of elements from
+// each end at a time, recording the offsets of the misplaced elements in each -
+// the comparison results are only ever added to a count, so there's nothing to
+// mispredict. the two blocks' misplaced elements are then swapped pairwise, and
+// whichever block has run out of them is replaced by the next one in.
+// what's left in the middle (at most two blocks) is partitioned as lomuto_partition
+// does, so the result is the same as lomuto_partition's: the partition value ends up
+// at the returned point, every element to the left of it is less than it, and every
+// element to the right is greater than or equal to it:
+template <typename RandomIt, typename Compare = std::less<>>
+RandomIt block_partition(RandomIt first, RandomIt last, Compare compare = Compare()) {
 
-        int partition_index = partition(array, start, end);
+    RandomIt partition_value = last - 1;
 
-        quick_sort(array, start, partition_index - 1);
-        quick_sort(array, partition_index + 1, end);
+    // [first, left) are known to be < partition_value, and
+    // (right, partition_value) are known to be >= partition_value:
+    RandomIt left = first;
+    RandomIt right = last - 2;
+
+    // offsets (from left/right) of misplaced elements within the current blocks:
+    unsigned char left_offsets[partition_block_size];
+    unsigned char right_offsets[partition_block_size];
+    int left_count = 0, left_first = 0;
+    int right_count = 0, right_first = 0;
+
+    while (right - left + 1 > 2 * partition_block_size) {
+
+        if (left_count == 0) {
+            left_first = 0;
+            for (int i = 0; i < partition_block_size; i++) {
+                left_offsets[left_count] = i;
+                left_count += !compare(left[i], *partition_value);
+            }
+        }
+
+        if (right_count == 0) {
+            right_first = 0;
+            for (int i = 0; i < partition_block_size; i++) {
+                right_offsets[right_count] = i;
+                right_count += compare(*(right - i), *partition_value);
+            }
+        }
+
+        int swap_count = std::min(left_count, right_count);
+        for (int i = 0; i < swap_count; i++) {
+            std::iter_swap(left + left_offsets[left_first + i], right - right_offsets[right_first + i]);
+        }
+
+        left_count -= swap_count;
+        right_count -= swap_count;
+        left_first += swap_count;
+        right_first += swap_count;
+
+        // a block is done once all of it's misplaced elements have been swapped:
+        if (left_count == 0) { left += partition_block_size; }
+        if (right_count == 0) { right -= partition_block_size; }
 
     }
 
+    // what's left is at most two blocks (one of which may still contain some
+    // misplaced elements that we have offsets for, but it's simpler just to
+    // look at them again), so just partition it the same way as lomuto_partition:
+    RandomIt partition_point = left;
+    for (RandomIt i = left; i != right + 1; ++i) {
+        if (compare(*i, *partition_value)) {
+            std::iter_swap(i, partition_point);
+            ++partition_point;
+        }
+    }
+
+    std::iter_swap(partition_value, partition_point);
+
+    return partition_point;
+
+}
+
+int block_partition(std::vector<int> &array, int start, int end) {
+    return block_partition(array.begin() + start, array.begin() + end + 1) - array.begin();
+}
+
+enum class partition_method {
+    lomuto = 0,
+    block = 1
+};
+
+template <typename RandomIt, typename Compare>
+RandomIt partition(RandomIt first, RandomIt last, Compare compare, partition_method method) {
+
+    if (method == partition_method::block) {
+        return block_partition(first, last, compare);
+    }
+
+    return lomuto_partition(first, last, compare);
+
 }
 
-void quick_sort(std::vector<int> &array) {
-    quick_sort(array, 0, array.size() - 1);
+int partition(std::vector<int> &array, int start, int end, partition_method method) {
+    return partition(array.begin() + start, array.begin() + end + 1, std::less<>(), method) - array.begin();
+}
+
+// sorts [first, last) such that compare(a, b) is true if a should come before b,
+// swapping rather than copying, so that it works for move-only types:
+template <typename RandomIt, typename Compare = std::less<>, typename BaseCase = recursive_base_case>
+void quick_sort(RandomIt first, RandomIt last, Compare compare = Compare(),
+                    partition_method method = partition_method::lomuto, BaseCase base_case = BaseCase()) {
+
+    if (base_case(first, last, compare)) { return; }
+
+    if (last - first > 1) {
+
+        RandomIt partition_point = partition(first, last, compare, method);
+
+        quick_sort(first, partition_point, compare, method, base_case);
+        quick_sort(partition_point + 1, last, compare, method, base_case);
+
+    }
+
+}
+
+void quick_sort(std::vector<int> &array, int start, int end, partition_method method = partition_method::lomuto,
+                    base_case_method base_case = base_case_method::recurse) {
+
+    if (start >= end) { return; }
+
+    if (base_case == base_case_method::sorting_network) {
+        quick_sort(array.begin() + start, array.begin() + end + 1, std::less<>(), method, network_base_case());
+    } else {
+        quick_sort(array.begin() + start, array.begin() + end + 1, std::less<>(), method);
+    }
+
+}
+
+void quick_sort(std::vector<int> &array, partition_method method = partition_method::lomuto,
+                    base_case_method base_case = base_case_method::recurse) {
+    quick_sort(array, 0, array.size() - 1, method, base_case);
 }
 
 // quick_sort will actually perform very poorly (O(n^2)) if the 
@@ -61,33 +248,53 @@ void quick_sort(std::vector<int> &array) {
 // a partition_value at random within partition. Or, more precisely, 
 // we move a randomly chosen element to the end before calling partition:
 
-void randomised_quick_sort(std::vector<int> &array, int start, int end, const std::function<double()> &get_random) {
+template <typename RandomIt, typename Compare, typename BaseCase = recursive_base_case>
+void randomised_quick_sort(RandomIt first, RandomIt last, const std::function<double()> &get_random, Compare compare,
+                            partition_method method = partition_method::lomuto, BaseCase base_case = BaseCase()) {
 
-    if (start < end) {
+    if (base_case(first, last, compare)) { return; }
 
-        {
-            // swap a random element of array[start ... end]
-            // to the end:
-            int swap_index = get_random() * (end - start) + start;
-            int temp = array[swap_index];
-            array[swap_index] = array[end];
-            array[end] = temp;
-        }
+    if (last - first > 1) {
+
+        // swap a random element of [first, last) to the end:
+        std::iter_swap(first + static_cast<int>(get_random() * (last - first - 1)), last - 1);
+
+        RandomIt partition_point = partition(first, last, compare, method);
+
+        randomised_quick_sort(first, partition_point, get_random, compare, method, base_case);
+        randomised_quick_sort(partition_point + 1, last, get_random, compare, method, base_case);
+
+    }
+
+}
+
+template <typename RandomIt, typename Compare = std::less<>>
+void randomised_quick_sort(RandomIt first, RandomIt last, Compare compare = Compare(),
+                            partition_method method = partition_method::lomuto) {
+    xoshiro256_star_star &generator = default_generator();
+    randomised_quick_sort(first, last, [&generator]() {
+        return uniform_real(generator);
+    }, compare, method);
+}
 
-        int partition_index = partition(array, start, end);
+void randomised_quick_sort(std::vector<int> &array, int start, int end, const std::function<double()> &get_random,
+                            partition_method method = partition_method::lomuto,
+                            base_case_method base_case = base_case_method::recurse) {
 
-        randomised_quick_sort(array, start, partition_index - 1, get_random);
-        randomised_quick_sort(array, partition_index + 1, end, get_random);
+    if (start >= end) { return; }
 
+    if (base_case == base_case_method::sorting_network) {
+        randomised_quick_sort(array.begin() + start, array.begin() + end + 1, get_random, std::less<>(), method, network_base_case());
+    } else {
+        randomised_quick_sort(array.begin() + start, array.begin() + end + 1, get_random, std::less<>(), method);
     }
 
 }
 
-void randomised_quick_sort(std::vector<int> &array) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> distribution(0.0, 1.0);
-    randomised_quick_sort(array, 0, array.size() - 1, [&gen, &distribution]() {
-        return distribution(gen);
-    });
+void randomised_quick_sort(std::vector<int> &array, partition_method method = partition_method::lomuto,
+                            base_case_method base_case = base_case_method::recurse) {
+    xoshiro256_star_star &generator = default_generator();
+    randomised_quick_sort(array, 0, array.size() - 1, [&generator]() {
+        return uniform_real(generator);
+    }, method, base_case);
 }
@@ -0,0 +1,105 @@
+
+// an LSD radix sort (ref: https://en.wikipedia.org/wiki/Radix_sort) for integer keys.
+// the keys are split into digits of digit_bits bits (8 by default; 11 is often
+// quicker for 32-bit keys since it only needs 3 passes), and the array is then
+// stably distributed by each digit in turn, starting from the least significant.
+// a few details:
+// - the histograms for every pass are built up front, in a single read of the array;
+// - passes where every key has the same digit are skipped, since they wouldn't
+//   change anything (e.g. the upper bytes of small positive keys);
+// - signed keys have their sign bit flipped, so that negative keys (which look
+//   like large unsigned values) come first;
+// - there's an overload taking a get_key function, so that records can be sorted
+//   by an integer field.
+// like bottom_up_merge_sort, it ping-pongs between array and a buffer, which can be
+// passed in to be reused between calls (and array and buffer may swap contents).
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+template <int digit_bits = 8, typename T, typename KeyFunction>
+void radix_sort(std::vector<T> &array, KeyFunction get_key, std::vector<T> &buffer) {
+
+    using key_type = std::decay_t<decltype(get_key(array[0]))>;
+    using unsigned_key_type = std::make_unsigned_t<key_type>;
+
+    static_assert(std::is_integral<key_type>::value, "radix_sort keys must be integers");
+    static_assert(digit_bits > 0 && digit_bits <= 16, "radix_sort digit_bits must be in [1, 16]");
+
+    constexpr int key_bits = 8 * sizeof(key_type);
+    constexpr int num_passes = (key_bits + digit_bits - 1) / digit_bits;
+    constexpr int num_buckets = 1 << digit_bits;
+    constexpr unsigned_key_type digit_mask = num_buckets - 1;
+    // flipping the sign bit maps signed keys onto unsigned keys in the same order:
+    constexpr unsigned_key_type sign_bit = std::is_signed<key_type>::value
+        ? unsigned_key_type(1) << (key_bits - 1) : 0;
+
+    auto get_unsigned_key = [&get_key](const T &value) {
+        return static_cast<unsigned_key_type>(get_key(value)) ^ sign_bit;
+    };
+
+    int size = array.size();
+    if (size < 2) { return; }
+
+    // 1) count the occurrences of each digit, for every pass at once:
+    std::array<std::array<int, num_buckets>, num_passes> counts = {};
+
+    for (int i = 0; i < size; i++) {
+        unsigned_key_type key = get_unsigned_key(array[i]);
+        for (int pass = 0; pass < num_passes; pass++) {
+            counts[pass][(key >> (pass * digit_bits)) & digit_mask]++;
+        }
+    }
+
+    // 2) distribute by each digit in turn:
+    buffer.resize(size);
+    std::vector<T> *source = &array;
+    std::vector<T> *destination = &buffer;
+
+    for (int pass = 0; pass < num_passes; pass++) {
+
+        const int shift = pass * digit_bits;
+
+        // if every key has the same digit then this pass won't change anything:
+        unsigned_key_type first_digit = (get_unsigned_key((*source)[0]) >> shift) & digit_mask;
+        if (counts[pass][first_digit] == size) { continue; }
+
+        // turn the counts into the index at which each bucket starts:
+        std::array<int, num_buckets> &offsets = counts[pass];
+        int total = 0;
+        for (int bucket = 0; bucket < num_buckets; bucket++) {
+            int count = offsets[bucket];
+            offsets[bucket] = total;
+            total += count;
+        }
+
+        for (int i = 0; i < size; i++) {
+            unsigned_key_type digit = (get_unsigned_key((*source)[i]) >> shift) & digit_mask;
+            (*destination)[offsets[digit]++] = std::move((*source)[i]);
+        }
+
+        std::swap(source, destination);
+
+    }
+
+    if (source != &array) {
+        array.swap(buffer);
+    }
+
+}
+
+template <int digit_bits = 8, typename T, typename KeyFunction>
+void radix_sort(std::vector<T> &array, KeyFunction get_key) {
+    std::vector<T> buffer;
+    radix_sort<digit_bits>(array, get_key, buffer);
+}
+
+template <int digit_bits = 8, typename T>
+void radix_sort(std::vector<T> &array) {
+    std::vector<T> buffer;
+    radix_sort<digit_bits>(array, [](T value) { return value; }, buffer);
+}
@@ -0,0 +1,178 @@
+
+// selection - finding the k smallest values in an array without sorting all of it:
+// - quick_select rearranges the array so that array[k] is the value that would be
+//   there if the array were sorted, with everything before it <= it and everything
+//   after it >= it (like std::nth_element). it's quick_sort, but only recursing into
+//   the side containing k, so O(n) on average. like intro_sort, if it takes too many
+//   partitions, it falls back to using the median of medians as the pivot, which
+//   guarantees O(n) in the worst case too;
+// - partial_heap_sort rearranges the array so that array[0 ... k - 1] are the k
+//   smallest values in sorted order, by keeping a max-heap of the k smallest values
+//   seen so far, in O(n log k);
+// - smallest_k does the same, but copies the k smallest values out rather than
+//   rearranging the array.
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "./insertion-sort.h"
+#include "./heap-sort.h"
+#include "./quick-sort.h"
+
+// ranges of this size or smaller are just sorted with insertion_sort:
+constexpr int selection_insertion_threshold = 16;
+
+// the deterministic (and worst case O(n)) selection, using the median of medians
+// as the pivot (ref: https://en.wikipedia.org/wiki/Median_of_medians). leaves
+// array[k] as it would be if array[start ... end] were sorted:
+void median_of_medians_select(std::vector<int> &array, int start, int end, int k) {
+
+    while (end - start + 1 > selection_insertion_threshold) {
+
+        // sort each group of 5 and move it's median to the front of the range:
+        int num_medians = 0;
+        for (int group_start = start; group_start <= end; group_start += 5) {
+            int group_end = std::min(group_start + 4, end);
+            insertion_sort(array, group_start, group_end);
+            std::swap(array[start + num_medians], array[(group_start + group_end) / 2]);
+            num_medians++;
+        }
+
+        // find the median of the medians, and use it as the pivot:
+        int median_index = start + (num_medians - 1) / 2;
+        median_of_medians_select(array, start, start + num_medians - 1, median_index);
+        std::swap(array[median_index], array[end]);
+
+        // NB: using three_way_partition, since partition does badly with duplicates:
+        std::pair<int, int> equal_range = three_way_partition(array, start, end);
+
+        if (k < equal_range.first) {
+            end = equal_range.first - 1;
+        } else if (k > equal_range.second) {
+            start = equal_range.second + 1;
+        } else {
+            return;
+        }
+
+    }
+
+    insertion_sort(array, start, end);
+
+}
+
+// leaves array[k] as it would be if array[start ... end] were sorted:
+void quick_select(std::vector<int> &array, int start, int end, int k) {
+
+    // allow 2 * log2(n) partitions before falling back to median_of_medians_select:
+    int depth_limit = 0;
+    for (int size = end - start + 1; size > 1; size >>= 1) {
+        depth_limit += 2;
+    }
+
+    while (end - start + 1 > selection_insertion_threshold) {
+
+        if (depth_limit == 0) {
+            median_of_medians_select(array, start, end, k);
+            return;
+        }
+        depth_limit--;
+
+        // median-of-three pivot, moved to the end for partition:
+        int middle = start + (end - start) / 2;
+        if (array[middle] < array[start]) { std::swap(array[start], array[middle]); }
+        if (array[end] < array[middle]) { std::swap(array[middle], array[end]); }
+        if (array[middle] < array[start]) { std::swap(array[start], array[middle]); }
+        bool duplicates_likely = array[start] == array[middle] || array[middle] == array[end];
+        std::swap(array[middle], array[end]);
+
+        if (duplicates_likely) {
+
+            std::pair<int, int> equal_range = three_way_partition(array, start, end);
+
+            if (k < equal_range.first) {
+                end = equal_range.first - 1;
+            } else if (k > equal_range.second) {
+                start = equal_range.second + 1;
+            } else {
+                return;
+            }
+
+        } else {
+
+            int partition_index = block_partition(array, start, end);
+
+            if (k < partition_index) {
+                end = partition_index - 1;
+            } else if (k > partition_index) {
+                start = partition_index + 1;
+            } else {
+                return;
+            }
+
+        }
+
+    }
+
+    insertion_sort(array, start, end);
+
+}
+
+// returns the k-th smallest value (counting from 0), leaving it at array[k]:
+int quick_select(std::vector<int> &array, int k) {
+
+    quick_select(array, 0, array.size() - 1, k);
+    return array[k];
+
+}
+
+// leaves the k smallest values in array[0 ... k - 1], in sorted order (and the
+// rest of the array in no particular order):
+void partial_heap_sort(std::vector<int> &array, int k) {
+
+    int size = array.size();
+    k = std::min(k, size);
+    if (k <= 0) { return; }
+
+    // array[0 ... k - 1] is a max-heap of the k smallest values seen so far:
+    array_to_max_heap(array, 0, k - 1);
+
+    for (int i = k; i < size; i++) {
+
+        // if array[i] is smaller than the largest of them then swap it in:
+        if (array[i] < array[0]) {
+            std::swap(array[i], array[0]);
+            fix_max_heap_subtree(array, 0, k);
+        }
+
+    }
+
+    heap_sort(array, 0, k - 1);
+
+}
+
+// returns the k smallest values in array, in sorted order:
+std::vector<int> smallest_k(const std::vector<int> &array, int k) {
+
+    int size = array.size();
+    k = std::max(0, std::min(k, size));
+
+    std::vector<int> heap(array.begin(), array.begin() + k);
+    if (k == 0) { return heap; }
+
+    array_to_max_heap(heap);
+
+    for (int i = k; i < size; i++) {
+        if (array[i] < heap[0]) {
+            heap[0] = array[i];
+            fix_max_heap_subtree(heap, 0, k);
+        }
+    }
+
+    heap_sort(heap);
+
+    return heap;
+
+}
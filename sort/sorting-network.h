@@ -0,0 +1,294 @@
+
+// sorting networks (ref: https://en.wikipedia.org/wiki/Bitonic_sorter) for small,
+// fixed size arrays of ints - 8, 16, 32 or 64 elements. a sorting network is a
+// fixed sequence of compare-exchanges, so (unlike insertion_sort, or recursing
+// down to single elements) there are no data dependent branches, and the
+// compare-exchanges can be done with min/max.
+// which version gets compiled depends on the instruction sets enabled when
+// compiling (e.g. with -mavx2, -msse4.1 or -march=native):
+// - AVX2: the values are held in 8-wide vectors;
+// - SSE4.1: the values are held in 4-wide vectors;
+// - otherwise: a scalar version using std::min/std::max.
+// network_sort sorts any range of up to sorting_network_max_size elements, by
+// padding it out to the next network size, which is what the recursive sorts use
+// as their base case when passed base_case_method::sorting_network.
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <climits>
+
+#include "./insertion-sort.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+// the largest range that network_sort can sort:
+constexpr int sorting_network_max_size = 64;
+
+enum class base_case_method {
+    recurse = 0,
+    sorting_network = 1
+};
+
+// each set of network operations provides a vector type holding width values, and:
+// - min/max: element-wise;
+// - reverse: reverses the order of the elements;
+// - exchange_within: compare-exchanges elements i and i ^ distance (for distance < width);
+// - flip_within: compare-exchanges elements i and i ^ (block - 1) (for block <= width).
+// in both cases the smaller value ends up in the lower element.
+
+#if defined(__AVX2__)
+
+struct sorting_network_ops {
+
+    using vector = __m256i;
+    static constexpr int width = 8;
+
+    static vector load(const int *values) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)); }
+    static void store(int *values, vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), v); }
+    static vector min(vector a, vector b) { return _mm256_min_epi32(a, b); }
+    static vector max(vector a, vector b) { return _mm256_max_epi32(a, b); }
+
+    static vector reverse(vector v) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    static vector exchange_within(vector v, int distance) {
+        if (distance == 1) {
+            vector partner = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+            return _mm256_blend_epi32(min(v, partner), max(v, partner), 0xAA);
+        } else if (distance == 2) {
+            vector partner = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+            return _mm256_blend_epi32(min(v, partner), max(v, partner), 0xCC);
+        } else {
+            vector partner = _mm256_permute2x128_si256(v, v, 1);
+            return _mm256_blend_epi32(min(v, partner), max(v, partner), 0xF0);
+        }
+    }
+
+    static vector flip_within(vector v, int block) {
+        if (block == 2) {
+            return exchange_within(v, 1);
+        } else if (block == 4) {
+            vector partner = _mm256_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+            return _mm256_blend_epi32(min(v, partner), max(v, partner), 0xCC);
+        } else {
+            vector partner = reverse(v);
+            return _mm256_blend_epi32(min(v, partner), max(v, partner), 0xF0);
+        }
+    }
+
+};
+
+#elif defined(__SSE4_1__)
+
+struct sorting_network_ops {
+
+    using vector = __m128i;
+    static constexpr int width = 4;
+
+    static vector load(const int *values) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)); }
+    static void store(int *values, vector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(values), v); }
+    static vector min(vector a, vector b) { return _mm_min_epi32(a, b); }
+    static vector max(vector a, vector b) { return _mm_max_epi32(a, b); }
+
+    static vector reverse(vector v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+    // NB: _mm_blend_epi16 works on 16-bit elements, so each 32-bit element needs two bits of the mask:
+    static vector exchange_within(vector v, int distance) {
+        if (distance == 1) {
+            vector partner = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+            return _mm_blend_epi16(min(v, partner), max(v, partner), 0xCC);
+        } else {
+            vector partner = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+            return _mm_blend_epi16(min(v, partner), max(v, partner), 0xF0);
+        }
+    }
+
+    static vector flip_within(vector v, int block) {
+        if (block == 2) {
+            return exchange_within(v, 1);
+        } else {
+            vector partner = reverse(v);
+            return _mm_blend_epi16(min(v, partner), max(v, partner), 0xF0);
+        }
+    }
+
+};
+
+#else
+
+struct sorting_network_ops {
+
+    using vector = int;
+    static constexpr int width = 1;
+
+    static vector load(const int *values) { return *values; }
+    static void store(int *values, vector v) { *values = v; }
+    static vector min(vector a, vector b) { return std::min(a, b); }
+    static vector max(vector a, vector b) { return std::max(a, b); }
+    static vector reverse(vector v) { return v; }
+
+    // NB: with a width of 1, there's nothing within a vector to exchange:
+    static vector exchange_within(vector v, int) { return v; }
+    static vector flip_within(vector v, int) { return v; }
+
+};
+
+#endif
+
+// sorts values[0 ... size - 1] in place, where size is a power of two and a multiple
+// of sorting_network_ops::width. this is a bitonic sorter, but arranged so that every
+// compare-exchange puts the smaller value in the lower element: each merge of two
+// sorted blocks of size block / 2 starts by comparing element i with element
+// i ^ (block - 1) (i.e. the second block is compared in reverse order), and is then
+// finished off by comparing elements i and i ^ distance for distance = block / 4, ..., 1:
+template <int size>
+void sorting_network(int *values) {
+
+    using ops = sorting_network_ops;
+    constexpr int width = ops::width;
+    constexpr int num_vectors = size / width;
+
+    static_assert(size >= width && size % width == 0 && (size & (size - 1)) == 0,
+                    "sorting_network size must be a power of two, and a multiple of the vector width");
+
+    typename ops::vector vectors[num_vectors];
+    for (int i = 0; i < num_vectors; i++) {
+        vectors[i] = ops::load(values + i * width);
+    }
+
+    for (int block = 2; block <= size; block *= 2) {
+
+        if (block <= width) {
+            for (int i = 0; i < num_vectors; i++) {
+                vectors[i] = ops::flip_within(vectors[i], block);
+            }
+        } else {
+            // vector a is paired with vector b = a ^ (block / width - 1), in reverse:
+            int partner_mask = block / width - 1;
+            for (int a = 0; a < num_vectors; a++) {
+                int b = a ^ partner_mask;
+                if (b < a) { continue; }
+                typename ops::vector reversed = ops::reverse(vectors[b]);
+                typename ops::vector larger = ops::max(vectors[a], reversed);
+                vectors[a] = ops::min(vectors[a], reversed);
+                vectors[b] = ops::reverse(larger);
+            }
+        }
+
+        for (int distance = block / 4; distance >= 1; distance /= 2) {
+
+            if (distance < width) {
+                for (int i = 0; i < num_vectors; i++) {
+                    vectors[i] = ops::exchange_within(vectors[i], distance);
+                }
+            } else {
+                int partner_mask = distance / width;
+                for (int a = 0; a < num_vectors; a++) {
+                    int b = a ^ partner_mask;
+                    if (b < a) { continue; }
+                    typename ops::vector larger = ops::max(vectors[a], vectors[b]);
+                    vectors[a] = ops::min(vectors[a], vectors[b]);
+                    vectors[b] = larger;
+                }
+            }
+
+        }
+
+    }
+
+    for (int i = 0; i < num_vectors; i++) {
+        ops::store(values + i * width, vectors[i]);
+    }
+
+}
+
+// sorts values[0 ... size - 1], where size <= sorting_network_max_size, by
+// padding it out with INT_MAX to the next network size.
+// NB: without SIMD, the scalar networks turn out to be slower than insertion_sort
+// (which, for ranges this small, mostly stays in cache and predicts well), so
+// that's used instead:
+void network_sort(int *values, int size) {
+
+    if (size < 2) { return; }
+
+    if (sorting_network_ops::width == 1) {
+        insertion_sort(values, values + size);
+        return;
+    }
+
+    int padded[sorting_network_max_size];
+    for (int i = 0; i < size; i++) { padded[i] = values[i]; }
+
+    if (size <= 8) {
+        for (int i = size; i < 8; i++) { padded[i] = INT_MAX; }
+        sorting_network<8>(padded);
+    } else if (size <= 16) {
+        for (int i = size; i < 16; i++) { padded[i] = INT_MAX; }
+        sorting_network<16>(padded);
+    } else if (size <= 32) {
+        for (int i = size; i < 32; i++) { padded[i] = INT_MAX; }
+        sorting_network<32>(padded);
+    } else {
+        for (int i = size; i < 64; i++) { padded[i] = INT_MAX; }
+        sorting_network<64>(padded);
+    }
+
+    for (int i = 0; i < size; i++) { values[i] = padded[i]; }
+
+}
+
+// sorts array[start ... end], where end - start + 1 <= sorting_network_max_size:
+void network_sort(std::vector<int> &array, int start, int end) {
+
+    if (start < end) {
+        network_sort(array.data() + start, end - start + 1);
+    }
+
+}
+
+// the generic recursive sorts (merge_sort and quick_sort) take a base case, which
+// is called (with the sort's comparator) on each range before it's split, and
+// returns whether it's dealt with (i.e. sorted) the range itself:
+// - recursive_base_case never does, so they recurse all the way down to single elements;
+// - network_base_case sorts ranges of up to sorting_network_max_size elements - with
+//   network_sort when they're ints (in an array or std::vector) sorted by std::less,
+//   and with insertion_sort otherwise.
+struct recursive_base_case {
+
+    template <typename RandomIt, typename Compare>
+    bool operator()(RandomIt, RandomIt, const Compare&) const { return false; }
+
+};
+
+struct network_base_case {
+
+    // whether network_sort can sort [first, last) according to compare:
+    template <typename RandomIt, typename Compare>
+    static constexpr bool is_network_sortable =
+        (std::is_same_v<RandomIt, int*> || std::is_same_v<RandomIt, std::vector<int>::iterator>)
+        && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<int>>);
+
+    template <typename RandomIt, typename Compare>
+    bool operator()(RandomIt first, RandomIt last, const Compare &compare) const {
+
+        if (last - first > sorting_network_max_size) { return false; }
+
+        if constexpr (is_network_sortable<RandomIt, Compare>) {
+            if (last - first > 1) { network_sort(&*first, last - first); }
+        } else {
+            insertion_sort(first, last, compare);
+        }
+        return true;
+
+    }
+
+};
@@ -0,0 +1,292 @@
+
+// sorting arrays of C-strings (by strcmp order, i.e. by unsigned bytes) without
+// copying the strings - only the pointers are moved around. a comparison sort
+// compares each pair of strings from the start, so strings with long common
+// prefixes get those prefixes re-scanned on every comparison. these avoid that by
+// keeping track of how many characters (depth) all of the strings in a range are
+// known to have in common:
+// - multikey_quick_sort (ref: https://www.cs.princeton.edu/~rs/strings/) is a
+//   quick_sort on the character at depth, using a three-way partition. the
+//   'less' and 'greater' parts are sorted at the same depth, but the 'equal' part
+//   all share another character, so it's sorted at depth + 1;
+// - msd_radix_sort distributes the strings into 256 buckets by the character at
+//   depth, then sorts each bucket at depth + 1. buckets smaller than
+//   msd_radix_sort_threshold aren't worth 256 counters, so they're given to
+//   multikey_quick_sort instead. each string's character is read once (into an
+//   'oracle' array) and then used for both the counting and the distributing.
+// both can (with string_key_cache::next_8_bytes) keep the next 8 characters of
+// each string packed into an integer next to it's pointer (most significant byte
+// first, so that comparing the integers compares the characters). this means
+// that most comparisons don't have to follow the pointer out to the string at
+// all, and that the multikey_quick_sort advances 8 characters at a time.
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// ranges of this size or smaller are sorted with an insertion sort:
+constexpr int string_sort_insertion_threshold = 16;
+
+// buckets smaller than this are given to multikey_quick_sort by msd_radix_sort:
+constexpr int msd_radix_sort_threshold = 1 << 10;
+
+enum class string_key_cache {
+    none = 0,
+    next_8_bytes = 1
+};
+
+// a string, along with (up to) 8 of it's characters, starting from some depth, packed
+// most significant byte first, and padded with zeroes after the end of the string:
+struct cached_string {
+    std::uint64_t key;
+    const char *string;
+};
+
+inline std::uint64_t load_string_key(const char *string, int depth) {
+
+    std::uint64_t key = 0;
+    for (int i = 0; i < 8; i++) {
+        unsigned char character = string[depth + i];
+        key |= static_cast<std::uint64_t>(character) << (56 - 8 * i);
+        if (character == 0) { break; }
+    }
+    return key;
+
+}
+
+// whether a key includes the end of it's string. since everything after the
+// end is zero, this is just whether the last byte is:
+inline bool string_key_has_end(std::uint64_t key) {
+    return (key & 0xFF) == 0;
+}
+
+inline unsigned char string_character(const char *string, int depth) {
+    return static_cast<unsigned char>(string[depth]);
+}
+
+// sorts strings[0 ... size - 1], which are known to have their first depth characters in common:
+void string_insertion_sort(const char **strings, int size, int depth) {
+
+    for (int i = 1; i < size; i++) {
+
+        const char *string = strings[i];
+        int j = i;
+
+        while (j > 0 && std::strcmp(strings[j - 1] + depth, string + depth) > 0) {
+            strings[j] = strings[j - 1];
+            j--;
+        }
+
+        strings[j] = string;
+
+    }
+
+}
+
+void string_insertion_sort(cached_string *strings, int size, int depth) {
+
+    for (int i = 1; i < size; i++) {
+
+        cached_string string = strings[i];
+        int j = i;
+
+        // only look at the strings themselves if the keys are equal (and haven't reached the end):
+        while (j > 0 && (strings[j - 1].key > string.key
+                || (strings[j - 1].key == string.key && !string_key_has_end(string.key)
+                    && std::strcmp(strings[j - 1].string + depth + 8, string.string + depth + 8) > 0))) {
+            strings[j] = strings[j - 1];
+            j--;
+        }
+
+        strings[j] = string;
+
+    }
+
+}
+
+// sorts strings[0 ... size - 1], which are known to have their first depth characters in common:
+void multikey_quick_sort(const char **strings, int size, int depth) {
+
+    while (size > string_sort_insertion_threshold) {
+
+        // median-of-three pivot character:
+        unsigned char a = string_character(strings[0], depth);
+        unsigned char b = string_character(strings[size / 2], depth);
+        unsigned char c = string_character(strings[size - 1], depth);
+        unsigned char pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        // invariant: strings[0 ... less_end - 1] have a character < pivot,
+        // strings[less_end ... i - 1] == pivot, and strings[greater_start ... size - 1] > pivot:
+        int less_end = 0;
+        int i = 0;
+        int greater_start = size;
+
+        while (i < greater_start) {
+
+            unsigned char character = string_character(strings[i], depth);
+
+            if (character < pivot) {
+                std::swap(strings[i++], strings[less_end++]);
+            } else if (character > pivot) {
+                std::swap(strings[i], strings[--greater_start]);
+            } else {
+                i++;
+            }
+
+        }
+
+        multikey_quick_sort(strings, less_end, depth);
+        multikey_quick_sort(strings + greater_start, size - greater_start, depth);
+
+        // if the pivot is the end of the string then the 'equal' strings are all
+        // identical, otherwise they're sorted by their next character:
+        if (pivot == 0) { return; }
+
+        strings += less_end;
+        size = greater_start - less_end;
+        depth++;
+
+    }
+
+    string_insertion_sort(strings, size, depth);
+
+}
+
+// sorts strings[0 ... size - 1], which are known to have their first depth characters
+// in common, and have their keys loaded from depth:
+void multikey_quick_sort(cached_string *strings, int size, int depth) {
+
+    while (size > string_sort_insertion_threshold) {
+
+        std::uint64_t a = strings[0].key;
+        std::uint64_t b = strings[size / 2].key;
+        std::uint64_t c = strings[size - 1].key;
+        std::uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        int less_end = 0;
+        int i = 0;
+        int greater_start = size;
+
+        while (i < greater_start) {
+
+            std::uint64_t key = strings[i].key;
+
+            if (key < pivot) {
+                std::swap(strings[i++], strings[less_end++]);
+            } else if (key > pivot) {
+                std::swap(strings[i], strings[--greater_start]);
+            } else {
+                i++;
+            }
+
+        }
+
+        multikey_quick_sort(strings, less_end, depth);
+        multikey_quick_sort(strings + greater_start, size - greater_start, depth);
+
+        if (string_key_has_end(pivot)) { return; }
+
+        // the 'equal' strings share the next 8 characters, so move on to the 8 after those:
+        strings += less_end;
+        size = greater_start - less_end;
+        depth += 8;
+
+        for (int j = 0; j < size; j++) {
+            strings[j].key = load_string_key(strings[j].string, depth);
+        }
+
+    }
+
+    string_insertion_sort(strings, size, depth);
+
+}
+
+void multikey_quick_sort(std::vector<const char*> &strings, string_key_cache cache = string_key_cache::none) {
+
+    int size = strings.size();
+
+    if (cache == string_key_cache::none) {
+        multikey_quick_sort(strings.data(), size, 0);
+        return;
+    }
+
+    std::vector<cached_string> cached(size);
+    for (int i = 0; i < size; i++) { cached[i] = { load_string_key(strings[i], 0), strings[i] }; }
+
+    multikey_quick_sort(cached.data(), size, 0);
+
+    for (int i = 0; i < size; i++) { strings[i] = cached[i].string; }
+
+}
+
+// sorts strings[0 ... size - 1], which are known to have their first depth characters
+// in common. buffer, oracle and (if caching keys) cached each have room for size
+// elements, and are there so that they only need to be allocated once:
+void msd_radix_sort(const char **strings, int size, int depth, const char **buffer,
+                        unsigned char *oracle, cached_string *cached) {
+
+    while (size >= msd_radix_sort_threshold) {
+
+        int counts[256] = {};
+        for (int i = 0; i < size; i++) {
+            oracle[i] = string_character(strings[i], depth);
+            counts[oracle[i]]++;
+        }
+
+        // if every string has the same character then there's nothing to distribute
+        // (and going round again rather than recursing means long common prefixes
+        // don't make for deep recursion):
+        if (counts[oracle[0]] == size) {
+            if (oracle[0] == 0) { return; }
+            depth++;
+            continue;
+        }
+
+        int bucket_starts[257];
+        bucket_starts[0] = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            bucket_starts[bucket + 1] = bucket_starts[bucket] + counts[bucket];
+        }
+
+        int offsets[256];
+        std::copy(bucket_starts, bucket_starts + 256, offsets);
+        for (int i = 0; i < size; i++) {
+            buffer[offsets[oracle[i]]++] = strings[i];
+        }
+        std::copy(buffer, buffer + size, strings);
+
+        // bucket 0 is the strings that have ended, which are all equal:
+        for (int bucket = 1; bucket < 256; bucket++) {
+            int start = bucket_starts[bucket];
+            msd_radix_sort(strings + start, counts[bucket], depth + 1, buffer, oracle, cached);
+        }
+
+        return;
+
+    }
+
+    if (!cached) {
+        multikey_quick_sort(strings, size, depth);
+        return;
+    }
+
+    for (int i = 0; i < size; i++) { cached[i] = { load_string_key(strings[i], depth), strings[i] }; }
+    multikey_quick_sort(cached, size, depth);
+    for (int i = 0; i < size; i++) { strings[i] = cached[i].string; }
+
+}
+
+void msd_radix_sort(std::vector<const char*> &strings, string_key_cache cache = string_key_cache::none) {
+
+    int size = strings.size();
+
+    std::vector<const char*> buffer(size);
+    std::vector<unsigned char> oracle(size);
+    std::vector<cached_string> cached(cache == string_key_cache::none ? 0 : size);
+
+    msd_radix_sort(strings.data(), size, 0, buffer.data(), oracle.data(), cached.empty() ? nullptr : cached.data());
+
+}
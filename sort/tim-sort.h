@@ -0,0 +1,245 @@
+
+// an adaptive merge sort along the lines of Timsort
+// (ref: https://github.com/python/cpython/blob/main/Objects/listsort.txt).
+// rather than splitting the array in half regardless of what's in it (like
+// merge_sort), it looks for runs that are already sorted:
+// - ascending runs are used as they are, and strictly descending runs are
+//   reversed (strictly so that reversing them doesn't break stability);
+// - runs shorter than min_run are extended to min_run elements with insertion_sort;
+// - runs are kept on a stack and merged whenever their lengths stop shrinking
+//   fast enough, so that merges are always between runs of similar sizes;
+// - merges 'gallop' (i.e. use an exponential search) whenever one run keeps
+//   winning, so that long stretches taken from one run are found in O(log n).
+// so an already sorted array is a single run, and takes O(n), and an array made
+// up of a few sorted runs takes O(n log(number of runs)).
+// NB: unlike Timsort, which copies whichever of the two runs being merged is
+// smaller, this always copies the left run (after trimming off the parts of
+// both runs that are already in place).
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "./insertion-sort.h"
+
+// the number of consecutive elements one run has to win before merging
+// switches to galloping:
+constexpr int tim_sort_min_gallop = 7;
+
+// picks a minimum run length in [32, 64] such that array_size / min_run is
+// (close to, but no more than) a power of two, so that the final merges are balanced:
+int tim_sort_min_run(int array_size) {
+
+    int remainder = 0;
+
+    while (array_size >= 64) {
+        remainder |= array_size & 1;
+        array_size >>= 1;
+    }
+
+    return array_size + remainder;
+
+}
+
+// finds the run starting at array[start], and returns the index of it's last
+// element. if it's a strictly descending run then it's reversed:
+int tim_sort_find_run(std::vector<int> &array, int start, int end) {
+
+    if (start == end) { return end; }
+
+    int run_end = start + 1;
+
+    if (array[run_end] < array[start]) {
+        while (run_end < end && array[run_end + 1] < array[run_end]) { run_end++; }
+        std::reverse(array.begin() + start, array.begin() + run_end + 1);
+    } else {
+        while (run_end < end && !(array[run_end + 1] < array[run_end])) { run_end++; }
+    }
+
+    return run_end;
+
+}
+
+// returns the number of elements in values[start ... start + length - 1] (which
+// must be sorted) that are <= key, if or_equal is true, or < key otherwise.
+// it checks 1, 3, 7, 15, ... elements in until it overshoots, and then binary
+// searches, so it takes O(log result):
+int gallop(int key, const std::vector<int> &values, int start, int length, bool or_equal) {
+
+    auto goes_before_key = [key, or_equal](int value) {
+        return or_equal ? !(key < value) : value < key;
+    };
+
+    // find low, high such that values[start + low - 1] goes before key,
+    // and values[start + high] doesn't:
+    int low = 0;
+    int high = 1;
+    while (high <= length && goes_before_key(values[start + high - 1])) {
+        low = high;
+        high = 2 * high + 1;
+    }
+    high = std::min(high, length + 1) - 1;
+
+    // the result is now in [low, high]:
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (goes_before_key(values[start + middle])) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+
+}
+
+// merges the adjacent sorted runs array[left_start ... left_start + left_length - 1]
+// and array[right_start ... right_start + right_length - 1]. min_gallop is carried
+// between merges, and is adjusted depending on how well galloping is working out:
+void tim_sort_merge(std::vector<int> &array, int left_start, int left_length,
+                        int right_start, int right_length, std::vector<int> &buffer, int &min_gallop) {
+
+    // elements at the start of the left run that are <= the first element of the
+    // right run are already in place:
+    int in_place = gallop(array[right_start], array, left_start, left_length, true);
+    left_start += in_place;
+    left_length -= in_place;
+    if (left_length == 0) { return; }
+
+    // as are elements at the end of the right run that are >= the last element
+    // of the left run:
+    right_length = gallop(array[left_start + left_length - 1], array, right_start, right_length, false);
+    if (right_length == 0) { return; }
+
+    // copy the left run out of the way, and merge back into array from left_start:
+    if (static_cast<int>(buffer.size()) < left_length) {
+        buffer.resize(left_length);
+    }
+    std::copy(array.begin() + left_start, array.begin() + left_start + left_length, buffer.begin());
+
+    int destination = left_start;
+    int left = 0;
+    int right = right_start;
+    int right_end = right_start + right_length;
+    int left_wins = 0;
+    int right_wins = 0;
+
+    while (left < left_length && right < right_end) {
+
+        // take one element at a time (taking from the left when equal, for stability):
+        if (array[right] < buffer[left]) {
+            array[destination++] = array[right++];
+            right_wins++;
+            left_wins = 0;
+        } else {
+            array[destination++] = buffer[left++];
+            left_wins++;
+            right_wins = 0;
+        }
+
+        if (left_wins < min_gallop && right_wins < min_gallop) { continue; }
+
+        // one run is winning consistently, so gallop until that stops paying off:
+        while (left < left_length && right < right_end) {
+
+            int left_count = gallop(array[right], buffer, left, left_length - left, true);
+            std::copy(buffer.begin() + left, buffer.begin() + left + left_count, array.begin() + destination);
+            destination += left_count;
+            left += left_count;
+            if (left == left_length) { break; }
+
+            // NB: destination < right, so copying forwards is safe:
+            int right_count = gallop(buffer[left], array, right, right_end - right, false);
+            std::copy(array.begin() + right, array.begin() + right + right_count, array.begin() + destination);
+            destination += right_count;
+            right += right_count;
+
+            // make galloping easier to get into next time:
+            min_gallop = std::max(1, min_gallop - 1);
+
+            if (left_count < tim_sort_min_gallop && right_count < tim_sort_min_gallop) { break; }
+
+        }
+
+        // and a bit harder, since we've just left it:
+        min_gallop += 2;
+        left_wins = 0;
+        right_wins = 0;
+
+    }
+
+    // whatever remains of the right run is already in place:
+    std::copy(buffer.begin() + left, buffer.begin() + left_length, array.begin() + destination);
+
+}
+
+// sorts array, using (and possibly growing) buffer for merges. as with
+// bottom_up_merge_sort, passing the same buffer in on repeated calls avoids allocating:
+void tim_sort(std::vector<int> &array, std::vector<int> &buffer) {
+
+    int size = array.size();
+    if (size < 2) { return; }
+
+    int min_run = tim_sort_min_run(size);
+    int min_gallop = tim_sort_min_gallop;
+
+    // the pending runs, as (start, length):
+    std::vector<std::pair<int, int>> runs;
+
+    auto merge_at = [&array, &buffer, &runs, &min_gallop](int i) {
+        tim_sort_merge(array, runs[i].first, runs[i].second, runs[i + 1].first, runs[i + 1].second, buffer, min_gallop);
+        runs[i].second += runs[i + 1].second;
+        runs.erase(runs.begin() + i + 1);
+    };
+
+    for (int start = 0; start < size;) {
+
+        int run_end = tim_sort_find_run(array, start, size - 1);
+
+        if (run_end - start + 1 < min_run) {
+            run_end = std::min(start + min_run, size) - 1;
+            insertion_sort(array, start, run_end);
+        }
+
+        runs.emplace_back(start, run_end - start + 1);
+        start = run_end + 1;
+
+        // merge runs until (reading down from the top of the stack) each run is
+        // shorter than the one below it, and shorter than the two below it combined
+        // (ref: http://envisage-project.eu/wp-content/uploads/2015/02/sorting.pdf
+        // for why it's necessary to check more than just the top three):
+        while (runs.size() > 1) {
+
+            int n = runs.size() - 2;
+
+            if ((n > 0 && runs[n - 1].second <= runs[n].second + runs[n + 1].second)
+                    || (n > 1 && runs[n - 2].second <= runs[n - 1].second + runs[n].second)) {
+                if (runs[n - 1].second < runs[n + 1].second) { n--; }
+            } else if (runs[n].second > runs[n + 1].second) {
+                break;
+            }
+
+            merge_at(n);
+
+        }
+
+    }
+
+    // merge whatever's left:
+    while (runs.size() > 1) {
+
+        int n = runs.size() - 2;
+        if (n > 0 && runs[n - 1].second < runs[n + 1].second) { n--; }
+        merge_at(n);
+
+    }
+
+}
+
+void tim_sort(std::vector<int> &array) {
+    std::vector<int> buffer;
+    tim_sort(array, buffer);
+}